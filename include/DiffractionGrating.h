@@ -2,11 +2,24 @@
 
 #include "Element.h"
 #include "Sources.h"
+#include "SlotMap.h"
 
 
 namespace my_math
 {
 
+  class DipolePack;
+
+  typedef void (*SecondaryFieldKernel)(const float *x, const float *y, const float *factors,
+                                       const size_t sources_number, const float point_x, const float point_y,
+                                       float *field_x, float *field_y);
+
+
+  /**
+    \brief Give you kernel which sums field of secondary sources with the best set of instructions.
+  */
+  SecondaryFieldKernel GetSecondaryFieldKernel(void);
+
   class DiffractionGrating : public Element
   {
    public:
@@ -20,7 +33,7 @@ namespace my_math
 
     DiffractionGrating(const DiffractionGrating & that);
 
-    DiffractionGrating(DiffractionGrating && that);
+    DiffractionGrating(DiffractionGrating && that) noexcept;
 
     DiffractionGrating & operator=(const DiffractionGrating & that) = delete;
 
@@ -86,16 +99,57 @@ namespace my_math
       \breif This function handles the collision of the diffraction grating and wave front.
       \param[in] position - Position of collision.
       \param[out] secondary_source_coordinate - Coordinate to set coordinate of created secondary_sources in it.
-      \param[out] secondary_source_number - Number of secondary_source, that was created. 
+      \param[out] secondary_source - Handle of secondary_source, that was created. 
       \param[out] is_main_wave - Function will set it in true if secondary wave was create firstly.   
       \return True - new secondary source was created. False - new secondary source wasn't created.
     */
-    bool HandleCollision(const Vector2 & position, Vector2 *secondary_source_coordinate, int* secondary_source_number,
+    bool HandleCollision(const Vector2 & position, Vector2 *secondary_source_coordinate, SlotHandle *secondary_source,
                          bool* is_main_wave);
 
-    void RemoveSecondarySource(const int ind, const WAVE_STATUSES wave_status);
 
-    Vector2 GetFieldStrength(const Vector2 & position, const float t, const std::vector<Dipole> &dipoles_) const;
+    /**
+      \brief Remove secondary source of secondary wave. Source created in the same slot later isn't removed.
+      \param[in] secondary_source - Handle given by HandleCollision( ).
+      \param[in] wave_status - Status of wave of source.
+    */
+    void RemoveSecondarySource(const SlotHandle & secondary_source, const WAVE_STATUSES wave_status);
+
+
+    /**
+      \brief Remove all secondary sources. It is called when secondary main wave is removed.
+    */
+    void RemoveSecondarySources(void);
+
+    /**
+      \brief Compute field of dipoles in all created secondary sources. It should be called once per time step
+             and after creating of secondary source.
+      \param[in] dipoles - Dipoles which create field in secondary sources.
+      \param[in] t - Time from start.
+    */
+    void UpdateBaseFieldStrengths(const DipolePack &dipoles, const float t);
+
+    Vector2 GetFieldStrength(const Vector2 & position, const float t) const;
+
+
+    /**
+      \brief Get field strength of secondary sources in point and its spatial derivatives in one pass.
+      \param[in] position - Point to get field strength in it.
+      \param[in] t - Time from start.
+      \param[out] jacobian - Derivatives of field strength.
+      \return Field strength.
+    */
+    Vector2 GetFieldStrength(const Vector2 & position, const float t, FieldJacobian *jacobian) const;
+
+
+    /**
+      \brief Get field strengths of secondary sources in many points.
+      \param[in] positions - Array of points.
+      \param[out] field_strengths - Array to write field strengths in it.
+      \param[in] points_number - Number of points.
+      \param[in] t - Time from start.
+    */
+    void GetFieldStrength(const Vector2 *positions, Vector2 *field_strengths, const size_t points_number,
+                          const float t) const;
 
    protected:
 
@@ -111,14 +165,29 @@ namespace my_math
 
     std::vector<sf::Sprite> hatches_;
 
+    // y coordinates of centers of slots from bottom to top. Slot ind is ind in active_indices_.
+    std::vector<float> slot_centers_;
+
     std::vector<SecondarySource> secondary_sources_;
 
     // proportions_[0] - x coordinate of left side. proportions_[1] - x coordinate of right side.
     // proportions_[2] - y coordinate of bottom side. proportions_[3] - y coordinate of top side. 
     float proportions_[NUMBER_SIDES];
 
-    // If secondary source exists in appropriate hatch(from bottom to top) it will be set by true.
-    std::vector<bool> secondary_sources_presence_;
+    // If secondary source exists in appropriate hatch(from bottom to top) it is index of source in active_slots_.
+    // Otherwise it is -1.
+    std::vector<int> active_indices_;
+
+    // Generations of slots. Generation is changed when source of slot is removed, so handles of it become stale.
+    std::vector<uint32_t> source_generations_;
+
+    // Created secondary sources without gaps for field summation. They are updated with active_indices_.
+    std::vector<int> active_slots_;
+    std::vector<float> active_x_;
+    std::vector<float> active_y_;
+
+    // SecondarySource::GetRadiationFactor( ) of active sources.
+    std::vector<float> active_factors_;
 
 
     /** 
@@ -134,12 +203,19 @@ namespace my_math
     /** 
       \breif Create secondary source in position.
       \param[in] position - Position to create secondary source.
-      \param[in] ind - ind in secondary_sources_presence_ and secondary_sources_ to create secondary source.
+      \param[in] ind - ind in active_indices_ and secondary_sources_ to create secondary source.
       \param[out] secondary_source_coordinate - Pointer on vector to set it into position of created secondary source.
       \return True - Secondary source was created. False - secondary source has already exist and wasn't created.
     */
     bool CreateSecondarySourceCollision(const Vector2 & position, const int ind, Vector2 *secondary_source_coordinate,
-                                          int *secondary_source_number, bool* is_main_wave);
+                                          SlotHandle *secondary_source, bool* is_main_wave);
+
+
+    /** 
+      \breif Remove secondary source of slot, if it exists. The last active source takes its place.
+      \param[in] ind - ind in active_indices_ and secondary_sources_.
+    */
+    void RemoveSlot(const int ind);
 
   };
 
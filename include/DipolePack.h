@@ -0,0 +1,244 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2.h"
+#include "Sources.h"
+
+//#define DIPOLE_PACK_DEBUG 1
+
+namespace my_math
+{
+
+// sin((CYCLIC_FREQUENCY * (t - distance / (DISTANT_SCALE * LIGHT_SPEED * TIME_SCALE)) + phase) * ONE_RADIAN) is
+// sin(time_phase - DISTANCE_PHASE_FACTOR * distance + phase * ONE_RADIAN). Look at Dipole::GetFieldStrength( ).
+const float DISTANCE_PHASE_FACTOR = CYCLIC_FREQUENCY * ONE_RADIAN / (DISTANT_SCALE * LIGHT_SPEED * TIME_SCALE);
+
+// Period of time phase in double. PI in float isn't exact enough to reduce phases of large t.
+const double TIME_PHASE_PERIOD = 6.283185307179586;
+
+
+/**
+  \brief Time phase CYCLIC_FREQUENCY * t * ONE_RADIAN reduced to [0, TIME_PHASE_PERIOD) in double. Phases of
+         dipoles and distances are added to it in float and sin kernels expect small arguments, so unreduced phase
+         of large t loses them.
+  \param[in] t - Time from start.
+  \return Time phase in radians.
+*/
+inline float GetTimePhase(const float t)
+{
+  const double time_phase = static_cast<double>(CYCLIC_FREQUENCY) * t * ONE_RADIAN;
+  return time_phase - TIME_PHASE_PERIOD * floor(time_phase / TIME_PHASE_PERIOD);
+}
+
+// Storage is padded to give kernels full SIMD blocks after the last dipole.
+const size_t DIPOLE_PACK_PADDING = 16;
+
+// Padding dipoles are far and have zero amplitude.
+const float DIPOLE_PACK_PADDING_POSITION = 1000000.;
+
+// Batch of points is handled by tiles: FIELD_POINTS_TILE points x FIELD_DIPOLES_TILE dipoles.
+// Tile of dipoles (6 arrays) stays in L1 cache while all points of tile use it.
+const size_t FIELD_POINTS_TILE = 64;
+const size_t FIELD_DIPOLES_TILE = 256;
+
+// Phasor of dipole on path is rotated from its anchor by angle up to it. Rotation by polynomials of the third and
+// the fourth orders has error about PATH_PHASOR_MAX_ROTATION^5 / 120.
+const float PATH_PHASOR_MAX_ROTATION = 0.1;
+
+/// Sets of instructions for DipolePack kernel.
+enum SIMD_LEVELS
+{
+  SCALAR_LEVEL = 0, ///< Kernel without SIMD instructions.
+  SSE2_LEVEL = 1, ///< 4 dipoles per instruction.
+  AVX2_LEVEL = 2 ///< 8 dipoles per instruction, two blocks per iteration.
+};
+
+
+/**
+  \brief Phasors of dipoles on traced path. Phase of dipole changes by DISTANCE_PHASE_FACTOR * (change of distance)
+         between points of path, so phasor in new point is the phasor in anchor point rotated by this small angle.
+         Rotation needs no sin and cos. Angle is counted from anchor, so errors don't accumulate along path.
+         Anchor of dipole is moved to the point, if angle is greater than PATH_PHASOR_MAX_ROTATION.
+         It is got by DipolePack::StartPath( ) and is valid while dipoles and time don't change.
+*/
+class PathPhasors {
+ public:
+  PathPhasors(void);
+
+ private:
+  friend class DipolePack;
+
+  float time_phase_;
+
+  // Distance from dipole to its anchor point and harmonic part of field there. They are padded as DipolePack.
+  std::vector<float> anchor_distance_;
+  std::vector<float> anchor_sin_;
+  std::vector<float> anchor_cos_;
+};
+
+
+/**
+  \brief Structure of arrays copy of Store::dipoles_ for vectorized field summation.
+*/
+class DipolePack {
+ public:
+  DipolePack(void);
+
+  /**
+    \brief Add dipole in the end of the pack.
+    \param[in] dipole - Dipole to copy position, direction, phase and amplitude from it.
+  */
+  void Push(const Dipole & dipole);
+
+  /**
+    \brief Add copy of dipole from other pack in the end of the pack.
+    \param[in] that - Pack to copy dipole from it.
+    \param[in] ind - Index of dipole in that.
+  */
+  void Push(const DipolePack & that, const size_t ind);
+
+  /**
+    \brief Remove dipole and keep order of other dipoles.
+    \param[in] ind - Index of dipole to remove.
+  */
+  void Remove(const size_t ind);
+
+  void Clear(void);
+
+  size_t Size(void) const;
+
+
+  /**
+    \brief Get sum of field strengths of dipoles [first, last) in point.
+    \param[in] point - Point to get field strength in it.
+    \param[in] t - Time from start.
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last) const;
+
+  Vector2 GetFieldStrength(const Vector2 & point, const float t) const;
+
+
+  /**
+    \brief Get sum of field strengths of dipoles [first, last) in point and its spatial derivatives in one pass.
+    \param[in] point - Point to get field strength in it.
+    \param[in] t - Time from start.
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+    \param[out] jacobian - Derivatives of field strength.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last,
+                           FieldJacobian *jacobian) const;
+
+
+  /**
+    \brief Prepare path to trace field along it at time t. All anchors of path are forgotten.
+    \param[out] path - Path to prepare.
+    \param[in] t - Time from start.
+  */
+  void StartPath(PathPhasors *path, const float t) const;
+
+
+  /**
+    \brief Get sum of field strengths of dipoles [first, last) in point of path. Phasors of dipoles are rotated from
+           anchors of path. Calls for disjoint ranges of dipoles can run in parallel on the same path.
+    \param[in] point - Point to get field strength in it.
+    \param[in] t - Time from start. It is the same as in StartPath( ).
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+    \param[in, out] path - Path with anchors of dipoles.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last,
+                           PathPhasors *path) const;
+
+  Vector2 GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last,
+                           FieldJacobian *jacobian, PathPhasors *path) const;
+
+
+  /**
+    \brief Get field strengths of all dipoles in many points.
+    \param[in] points - Array of points.
+    \param[out] field_strengths - Array to write field strengths in it.
+    \param[in] points_number - Number of points.
+    \param[in] t - Time from start.
+  */
+  void GetFieldStrength(const Vector2 *points, Vector2 *field_strengths, const size_t points_number,
+                        const float t) const;
+
+
+  /**
+    \brief Get field strengths of dipoles [first, last) in many points split in two time-independent parts.
+           Field strength at time t is in_phase_part * cos(CYCLIC_FREQUENCY * t * ONE_RADIAN) +
+           quadrature_part * sin(CYCLIC_FREQUENCY * t * ONE_RADIAN).
+    \param[in] points - Array of points.
+    \param[out] in_phase_parts - Array to write field strengths at zero time phase.
+    \param[out] quadrature_parts - Array to write field strengths at PI / 2 time phase.
+    \param[in] points_number - Number of points.
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+  */
+  void GetPhasors(const Vector2 *points, Vector2 *in_phase_parts, Vector2 *quadrature_parts,
+                  const size_t points_number, const size_t first, const size_t last) const;
+
+  /**
+    \brief Get front function of dipoles [first, last) in many points split in two time-independent parts. Field of
+           dipole is tangent to circles around it, so its front lines are iso-lines of
+           amplitude * DISTANT_SCALE * sin(time_phase - DISTANCE_PHASE_FACTOR * distance + phase) * ln(distance).
+           Gradient of the function rotated by 90 is field of dipole with angular coefficient replaced by its mean
+           2 / PI, and the mean is common for all dipoles, so it is dropped. The rest of field with
+           (angular coefficient - 2 / PI) is gradient of a function of angle, so no front function has iso-lines
+           along it, even for one dipole. Front function at time t is
+           in_phase_part * cos(CYCLIC_FREQUENCY * t * ONE_RADIAN) +
+           quadrature_part * sin(CYCLIC_FREQUENCY * t * ONE_RADIAN).
+    \param[in] points - Array of points.
+    \param[out] in_phase_parts - Array to write front function at zero time phase.
+    \param[out] quadrature_parts - Array to write front function at PI / 2 time phase.
+    \param[in] points_number - Number of points.
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+  */
+  void GetFrontPhasors(const Vector2 *points, float *in_phase_parts, float *quadrature_parts,
+                       const size_t points_number, const size_t first, const size_t last) const;
+
+  Vector2 GetPosition(const size_t ind) const;
+
+  // Unit vector of dipole direction.
+  Vector2 GetDirectionVector(const size_t ind) const;
+
+  // Phase in radians.
+  float GetPhase(const size_t ind) const;
+
+  float GetAmplitude(const size_t ind) const;
+
+
+  /**
+    \brief Give you set of instructions which was chosen at start of the program.
+  */
+  static SIMD_LEVELS GetSimdLevel(void);
+
+  bool Dump(void) const;
+
+ private:
+  size_t size_;
+
+  std::vector<float> x_;
+  std::vector<float> y_;
+
+  // Unit vector of dipole direction.
+  std::vector<float> direction_x_;
+  std::vector<float> direction_y_;
+
+  // Phase in radians.
+  std::vector<float> phase_;
+  std::vector<float> amplitude_;
+
+  void GetFieldStrengthByPhase(const Vector2 *points, Vector2 *field_strengths, const size_t points_number,
+                               const float time_phase, const size_t first, const size_t last) const;
+};
+
+} // End of namespace my_math.
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "Vector2.h"
+#include "DipolePack.h"
+
+//#define DIPOLE_TREE_DEBUG 1
+//#define VERIFY_DIPOLE_TREE 1
+
+namespace my_math
+{
+
+// Node with not more dipoles is a leaf. Leaves are summed exactly by DipolePack kernel.
+const size_t DIPOLE_TREE_LEAF_SIZE = 16;
+
+// Node with more different directions of dipoles isn't collapsed, its children are used instead.
+const size_t DIPOLE_TREE_MAX_DIRECTIONS = 16;
+
+// Maximal depth of tree. Dipoles in the same point can't be split by any depth.
+const int DIPOLE_TREE_MAX_DEPTH = 24;
+
+// Tree isn't used for smaller number of dipoles: exact sum is fast enough.
+const size_t DIPOLE_TREE_MIN_DIPOLES = 256;
+
+
+/**
+  \brief Quadtree over dipoles for far field summation (Barnes-Hut).
+         Field of distant node is expanded around its center up to the first order of shifts of dipoles.
+         Dipoles with the same direction are added as complex amplitudes, so node costs one term per direction.
+         Node is collapsed if (radius * (3 + DISTANCE_PHASE_FACTOR * distance) / (distance - radius))^2 < tolerance,
+         so its error is about tolerance * (sum of amplitudes) * DISTANT_SCALE / distance.
+*/
+class DipoleTree {
+ public:
+  DipoleTree(void);
+
+  DipoleTree(const DipoleTree & that) = delete;
+
+  DipoleTree & operator=(const DipoleTree & that) = delete;
+
+
+  /**
+    \brief Build tree over all dipoles of pack. Dipoles are copied in order of leaves.
+    \param[in] dipoles - Dipoles to build tree over them.
+  */
+  void Build(const DipolePack & dipoles);
+
+  void Invalidate(void);
+
+  bool IsValid(void) const;
+
+
+  /**
+    \brief Get approximate sum of field strengths of all dipoles in point.
+    \param[in] point - Point to get field strength in it.
+    \param[in] t - Time from start.
+    \param[in] tolerance - Relative error of every collapsed node. 0 - exact sum.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const Vector2 & point, const float t, const float tolerance) const;
+
+  bool Dump(void) const;
+
+ private:
+  // Dipoles of node with the same direction. Complex amplitude is amplitude * exp(i * phase).
+  struct DirectionGroup
+  {
+    float direction_x;
+    float direction_y;
+
+    // Sum of complex amplitudes.
+    std::complex<float> amplitude;
+
+    // Sum of complex amplitudes multiplied by shifts of dipoles from center of node.
+    std::complex<float> moment_x;
+    std::complex<float> moment_y;
+  };
+
+  struct Node
+  {
+    float center_x;
+    float center_y;
+
+    // Maximal distance from center to dipoles of node.
+    float radius;
+
+    // Dipoles of node are [first, last) in dipoles_.
+    size_t first;
+    size_t last;
+
+    // Children are [first_child, first_child + children_number) in nodes_. Leaf hasn't children.
+    size_t first_child;
+    size_t children_number;
+
+    // Groups are [first_group, last_group) in groups_. Node without groups is never collapsed.
+    size_t first_group;
+    size_t last_group;
+  };
+
+  bool is_valid_;
+
+  // Copy of dipoles in order of leaves, so every node is a range of it.
+  DipolePack dipoles_;
+
+  std::vector<Node> nodes_;
+  std::vector<DirectionGroup> groups_;
+
+  /**
+    \brief Fill node over dipoles of source pack with indices [begin, end) of indices. Children of node are
+           created together, so they are neighbours in nodes_.
+    \param[in] node_ind - Index of node in nodes_.
+  */
+  void BuildNode(const size_t node_ind, const DipolePack & source, std::vector<size_t> & indices, const size_t begin,
+                 const size_t end, const int depth);
+
+  void BuildGroups(Node & node);
+};
+
+} // End of namespace my_math.
@@ -22,6 +22,21 @@ const float DEFAULT_FRONT_ELEMENT_PCOUNT = 40.;
 const float FRONT_ELEMENT_MOVE_SPEED = 3 * 100000000;
 const float FRONT_ELEMENT_STEP = 0.5;
 const int MAX_ELEMENT_NUMBER = 20000;
+
+// Adaptive tracing of front. Tolerance is the largest local error of one step in pixels.
+const float DEFAULT_FRONT_TOLERANCE = 0.1;
+const float INITIAL_FRONT_STEP = 4 * FRONT_ELEMENT_STEP;
+const float MAX_FRONT_STEP = 64.;
+const float FRONT_STEP_SAFETY = 0.9;
+const float MIN_FRONT_STEP_FACTOR = 0.2;
+const float MAX_FRONT_STEP_FACTOR = 4.;
+
+// Front line turns not more than by this angle in radians on one step.
+const float MAX_FRONT_TURN = 0.5;
+
+// Knot of the last frame is corrected onto front line by not more than this number of iterations. Otherwise the rest
+// of front line is traced again.
+const int MAX_FRONT_CORRECTIONS = 3;
 const float DISTANT_SCALE = 0.1;
 
 const float DEFAULT_DIPOLE_DIRECTION = 180;
@@ -65,8 +80,15 @@ const float INTERFERENCE_LENGTH = 40.;
 const float STANDART_HANDLE_LENGTH  = 15.;
 const float SMALL_HANDLE_LENGTH = 10.;
 
-// If time to handle all actions is really big front element can flee diffraction grating.
-const float FIXING_MISSING_LENGTH = 10.;
+// Thread pool constants. DEFAULT_THREADS_NUMBER = 0 - use all hardware threads.
+const unsigned int DEFAULT_THREADS_NUMBER = 0;
+const bool DEFAULT_THREADS_PINNING = false;
+const size_t FIELD_CHUNK_SIZE = 512;
+const size_t MAX_FIELD_CHUNKS = 64;
+const size_t MOVE_WAVES_CHUNK_SIZE = 4;
+
+// Relative error of distant dipole clusters in field of dipoles. 0 - field is summed exactly.
+const float DEFAULT_FIELD_TOLERANCE = 0.02;
 
 /// Modes of drawing waves.
 enum DRAWN_SIDES
@@ -93,7 +115,7 @@ class Element {
 
   Element(const Element & that);
 
-  Element(Element && that);
+  Element(Element && that) noexcept;
 
   virtual bool Draw(sf::RenderWindow & window) = 0;
 
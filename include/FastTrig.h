@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FAST_TRIG_X86 1
+#include <immintrin.h>
+#endif /* __x86_64__ || __i386__ */
+
+//#define TRIG_ERRORS_REPORT 1
+
+namespace my_math
+{
+
+/// Accuracy of sin and cos in field kernels.
+enum TRIG_ACCURACIES
+{
+  FAST_TRIG = 0, ///< Short polynomials and two-part reduction, error is about 4e-5.
+  APPROXIMATE_TRIG = 1, ///< Minimax polynomials and three-part reduction, error is about 1e-7.
+  REFERENCE_TRIG = 2, ///< sin and cos of libm in double. Kernels don't use SIMD with it.
+  TRIG_ACCURACIES_NUMBER = 3
+};
+
+const TRIG_ACCURACIES DEFAULT_TRIG_ACCURACY = APPROXIMATE_TRIG;
+
+// Constants of sin approximation: argument reduction by PI / 2 in three parts and minimax polynomials on
+// [-PI / 4, PI / 4].
+const float TWO_OVER_PI = 0.636619772367581;
+const float REDUCTION_PART_1 = 1.5703125;
+const float REDUCTION_PART_2 = 4.837512969970703125e-4;
+const float REDUCTION_PART_3 = 7.54978995489188216e-8;
+const float SIN_COEFFICIENT_3 = -1.6666654611e-1;
+const float SIN_COEFFICIENT_5 = 8.3321608736e-3;
+const float SIN_COEFFICIENT_7 = -1.9515295891e-4;
+const float COS_COEFFICIENT_4 = 4.166664568298827e-2;
+const float COS_COEFFICIENT_6 = -1.388731625493765e-3;
+const float COS_COEFFICIENT_8 = 2.443315711809948e-5;
+
+// FAST_TRIG: the rest of PI / 2 in one part and Taylor polynomials of degree 5 and 6.
+const float FAST_REDUCTION_PART_2 = 4.8382679e-4;
+const float FAST_SIN_COEFFICIENT_3 = -1.6666667e-1;
+const float FAST_SIN_COEFFICIENT_5 = 8.3333333e-3;
+const float FAST_COS_COEFFICIENT_4 = 4.1666667e-2;
+const float FAST_COS_COEFFICIENT_6 = -1.3888889e-3;
+
+
+/**
+  \brief Set accuracy of sin and cos for all field computations. It can be changed at any time between frames.
+  \param[in] accuracy - New accuracy.
+*/
+void SetTrigAccuracy(const TRIG_ACCURACIES accuracy);
+
+TRIG_ACCURACIES GetTrigAccuracy(void);
+
+
+/**
+  \brief Print maximal absolute errors of sin and cos of every accuracy and set of instructions against libm.
+*/
+bool ReportTrigErrors(void);
+
+
+/**
+  \brief sin and cos by polynomials. Argument is reduced to [-PI / 4, PI / 4] by multiple of PI / 2.
+  \param[in] x - Argument in radians, |x| < 1e4.
+  \param[out] sin_x - sin(x).
+  \param[out] cos_x - cos(x).
+*/
+template <TRIG_ACCURACIES accuracy>
+inline void SinCosPolynomial(const float x, float *sin_x, float *cos_x)
+{
+  const float quadrant_float = std::nearbyint(x * TWO_OVER_PI);
+  const int quadrant = static_cast<int>(quadrant_float);
+
+  float reduced = x - quadrant_float * REDUCTION_PART_1;
+  float sin_part = 0.;
+  float cos_part = 0.;
+
+  if (accuracy == FAST_TRIG)
+  {
+    reduced -= quadrant_float * FAST_REDUCTION_PART_2;
+    const float square = reduced * reduced;
+    sin_part = ((FAST_SIN_COEFFICIENT_5 * square + FAST_SIN_COEFFICIENT_3) * square) * reduced + reduced;
+    cos_part = ((FAST_COS_COEFFICIENT_6 * square + FAST_COS_COEFFICIENT_4) * square) * square - 0.5f * square + 1;
+  }
+  else
+  {
+    reduced -= quadrant_float * REDUCTION_PART_2;
+    reduced -= quadrant_float * REDUCTION_PART_3;
+    const float square = reduced * reduced;
+    sin_part = (((SIN_COEFFICIENT_7 * square + SIN_COEFFICIENT_5) * square + SIN_COEFFICIENT_3) * square) * reduced +
+               reduced;
+    cos_part = (((COS_COEFFICIENT_8 * square + COS_COEFFICIENT_6) * square + COS_COEFFICIENT_4) * square) * square -
+               0.5f * square + 1;
+  }
+
+  switch (quadrant & 3)
+  {
+    case 0:
+      *sin_x = sin_part;
+      *cos_x = cos_part;
+      break;
+    case 1:
+      *sin_x = cos_part;
+      *cos_x = -sin_part;
+      break;
+    case 2:
+      *sin_x = -sin_part;
+      *cos_x = -cos_part;
+      break;
+    default:
+      *sin_x = -cos_part;
+      *cos_x = sin_part;
+      break;
+  }
+  return;
+}
+
+
+/**
+  \brief sin and cos with accuracy which was set by SetTrigAccuracy( ).
+*/
+inline void FastSinCos(const float x, float *sin_x, float *cos_x)
+{
+  switch (GetTrigAccuracy( ))
+  {
+    case FAST_TRIG:
+      SinCosPolynomial<FAST_TRIG>(x, sin_x, cos_x);
+      break;
+    case APPROXIMATE_TRIG:
+      SinCosPolynomial<APPROXIMATE_TRIG>(x, sin_x, cos_x);
+      break;
+    default:
+      *sin_x = sin(static_cast<double>(x));
+      *cos_x = cos(static_cast<double>(x));
+      break;
+  }
+  return;
+}
+
+inline float FastSin(const float x)
+{
+  float sin_x = 0.;
+  float cos_x = 0.;
+  FastSinCos(x, &sin_x, &cos_x);
+  return sin_x;
+}
+
+inline float FastCos(const float x)
+{
+  float sin_x = 0.;
+  float cos_x = 0.;
+  FastSinCos(x, &sin_x, &cos_x);
+  return cos_x;
+}
+
+
+#ifdef FAST_TRIG_X86
+
+/**
+  \brief sin and cos of 4 floats. Look at SinCosPolynomial( ).
+*/
+template <TRIG_ACCURACIES accuracy>
+inline void SinCosSse2(const __m128 x, __m128 *sin_x, __m128 *cos_x)
+{
+  const __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+  const __m128 quadrant_float = _mm_cvtepi32_ps(quadrant);
+
+  __m128 reduced = _mm_sub_ps(x, _mm_mul_ps(quadrant_float, _mm_set1_ps(REDUCTION_PART_1)));
+  __m128 sin_part;
+  __m128 cos_part;
+
+  if (accuracy == FAST_TRIG)
+  {
+    reduced = _mm_sub_ps(reduced, _mm_mul_ps(quadrant_float, _mm_set1_ps(FAST_REDUCTION_PART_2)));
+    const __m128 square = _mm_mul_ps(reduced, reduced);
+
+    sin_part = _mm_add_ps(_mm_mul_ps(square, _mm_set1_ps(FAST_SIN_COEFFICIENT_5)),
+                          _mm_set1_ps(FAST_SIN_COEFFICIENT_3));
+    sin_part = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_part, square), reduced), reduced);
+
+    cos_part = _mm_add_ps(_mm_mul_ps(square, _mm_set1_ps(FAST_COS_COEFFICIENT_6)),
+                          _mm_set1_ps(FAST_COS_COEFFICIENT_4));
+    cos_part = _mm_mul_ps(_mm_mul_ps(cos_part, square), square);
+    cos_part = _mm_add_ps(_mm_sub_ps(cos_part, _mm_mul_ps(square, _mm_set1_ps(0.5))), _mm_set1_ps(1.));
+  }
+  else
+  {
+    reduced = _mm_sub_ps(reduced, _mm_mul_ps(quadrant_float, _mm_set1_ps(REDUCTION_PART_2)));
+    reduced = _mm_sub_ps(reduced, _mm_mul_ps(quadrant_float, _mm_set1_ps(REDUCTION_PART_3)));
+    const __m128 square = _mm_mul_ps(reduced, reduced);
+
+    sin_part = _mm_add_ps(_mm_mul_ps(square, _mm_set1_ps(SIN_COEFFICIENT_7)), _mm_set1_ps(SIN_COEFFICIENT_5));
+    sin_part = _mm_add_ps(_mm_mul_ps(sin_part, square), _mm_set1_ps(SIN_COEFFICIENT_3));
+    sin_part = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin_part, square), reduced), reduced);
+
+    cos_part = _mm_add_ps(_mm_mul_ps(square, _mm_set1_ps(COS_COEFFICIENT_8)), _mm_set1_ps(COS_COEFFICIENT_6));
+    cos_part = _mm_add_ps(_mm_mul_ps(cos_part, square), _mm_set1_ps(COS_COEFFICIENT_4));
+    cos_part = _mm_mul_ps(_mm_mul_ps(cos_part, square), square);
+    cos_part = _mm_add_ps(_mm_sub_ps(cos_part, _mm_mul_ps(square, _mm_set1_ps(0.5))), _mm_set1_ps(1.));
+  }
+
+  // Odd quadrants swap sin and cos. sin changes sign in quadrants 2, 3 and cos in quadrants 1, 2.
+  const __m128 is_odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)),
+                                                         _mm_set1_epi32(1)));
+  const __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+  const __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)),
+                                                                        _mm_set1_epi32(2)), 30));
+
+  *sin_x = _mm_xor_ps(_mm_or_ps(_mm_and_ps(is_odd, cos_part), _mm_andnot_ps(is_odd, sin_part)), sin_sign);
+  *cos_x = _mm_xor_ps(_mm_or_ps(_mm_and_ps(is_odd, sin_part), _mm_andnot_ps(is_odd, cos_part)), cos_sign);
+  return;
+}
+
+template <TRIG_ACCURACIES accuracy>
+inline __m128 SinSse2(const __m128 x)
+{
+  __m128 sin_x;
+  __m128 cos_x;
+  SinCosSse2<accuracy>(x, &sin_x, &cos_x);
+  return sin_x;
+}
+
+template <TRIG_ACCURACIES accuracy>
+inline __m128 CosSse2(const __m128 x)
+{
+  __m128 sin_x;
+  __m128 cos_x;
+  SinCosSse2<accuracy>(x, &sin_x, &cos_x);
+  return cos_x;
+}
+
+
+/**
+  \brief sin and cos of 8 floats. Look at SinCosPolynomial( ).
+*/
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) inline void SinCosAvx2(const __m256 x, __m256 *sin_x, __m256 *cos_x)
+{
+  const __m256 quadrant_float = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)),
+                                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  const __m256i quadrant = _mm256_cvtps_epi32(quadrant_float);
+
+  __m256 reduced = _mm256_fnmadd_ps(quadrant_float, _mm256_set1_ps(REDUCTION_PART_1), x);
+  __m256 sin_part;
+  __m256 cos_part;
+
+  if (accuracy == FAST_TRIG)
+  {
+    reduced = _mm256_fnmadd_ps(quadrant_float, _mm256_set1_ps(FAST_REDUCTION_PART_2), reduced);
+    const __m256 square = _mm256_mul_ps(reduced, reduced);
+
+    sin_part = _mm256_fmadd_ps(square, _mm256_set1_ps(FAST_SIN_COEFFICIENT_5), _mm256_set1_ps(FAST_SIN_COEFFICIENT_3));
+    sin_part = _mm256_fmadd_ps(_mm256_mul_ps(sin_part, square), reduced, reduced);
+
+    cos_part = _mm256_fmadd_ps(square, _mm256_set1_ps(FAST_COS_COEFFICIENT_6), _mm256_set1_ps(FAST_COS_COEFFICIENT_4));
+    cos_part = _mm256_mul_ps(_mm256_mul_ps(cos_part, square), square);
+    cos_part = _mm256_add_ps(_mm256_fnmadd_ps(square, _mm256_set1_ps(0.5), cos_part), _mm256_set1_ps(1.));
+  }
+  else
+  {
+    reduced = _mm256_fnmadd_ps(quadrant_float, _mm256_set1_ps(REDUCTION_PART_2), reduced);
+    reduced = _mm256_fnmadd_ps(quadrant_float, _mm256_set1_ps(REDUCTION_PART_3), reduced);
+    const __m256 square = _mm256_mul_ps(reduced, reduced);
+
+    sin_part = _mm256_fmadd_ps(square, _mm256_set1_ps(SIN_COEFFICIENT_7), _mm256_set1_ps(SIN_COEFFICIENT_5));
+    sin_part = _mm256_fmadd_ps(sin_part, square, _mm256_set1_ps(SIN_COEFFICIENT_3));
+    sin_part = _mm256_fmadd_ps(_mm256_mul_ps(sin_part, square), reduced, reduced);
+
+    cos_part = _mm256_fmadd_ps(square, _mm256_set1_ps(COS_COEFFICIENT_8), _mm256_set1_ps(COS_COEFFICIENT_6));
+    cos_part = _mm256_fmadd_ps(cos_part, square, _mm256_set1_ps(COS_COEFFICIENT_4));
+    cos_part = _mm256_mul_ps(_mm256_mul_ps(cos_part, square), square);
+    cos_part = _mm256_add_ps(_mm256_fnmadd_ps(square, _mm256_set1_ps(0.5), cos_part), _mm256_set1_ps(1.));
+  }
+
+  // Odd quadrants swap sin and cos. sin changes sign in quadrants 2, 3 and cos in quadrants 1, 2.
+  const __m256 is_odd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)),
+                                                               _mm256_set1_epi32(1)));
+  const __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)),
+                                                                30));
+  const __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(
+      _mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+
+  *sin_x = _mm256_xor_ps(_mm256_blendv_ps(sin_part, cos_part, is_odd), sin_sign);
+  *cos_x = _mm256_xor_ps(_mm256_blendv_ps(cos_part, sin_part, is_odd), cos_sign);
+  return;
+}
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) inline __m256 SinAvx2(const __m256 x)
+{
+  __m256 sin_x;
+  __m256 cos_x;
+  SinCosAvx2<accuracy>(x, &sin_x, &cos_x);
+  return sin_x;
+}
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) inline __m256 CosAvx2(const __m256 x)
+{
+  __m256 sin_x;
+  __m256 cos_x;
+  SinCosAvx2<accuracy>(x, &sin_x, &cos_x);
+  return cos_x;
+}
+
+#endif /* FAST_TRIG_X86 */
+
+} // End of namespace my_math.
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+#include "Vector2.h"
+
+//#define FRONT_BUFFER_DEBUG 1
+
+namespace my_math
+{
+
+/**
+  \brief Front elements of all waves of one frame. Waves are traced into flat arrays of positions and strengths,
+         then all elements are drawn as quads of one vertex array by one draw call.
+*/
+class FrontBuffer {
+ public:
+  FrontBuffer(void);
+
+  void Clear(void);
+
+
+  /**
+    \brief Add front element in the end of buffer.
+    \param[in] position - Position of front element as position of FrontElement.
+    \param[in] strength - Field strength in the element. It sets color by FrontElement::GetStrengthColor( ).
+  */
+  void Push(const Vector2 & position, const float strength);
+
+  /**
+    \brief Add all front elements of other buffer in the end of buffer.
+    \param[in] that - Buffer to copy elements from it.
+  */
+  void Append(const FrontBuffer & that);
+
+  size_t Size(void) const;
+
+
+  /**
+    \brief Draw all front elements by one call. Colors are got in order of pushing.
+    \param[out] window - Window to draw elements.
+  */
+  bool Draw(sf::RenderWindow & window);
+
+  bool Dump(void) const;
+
+ private:
+  std::vector<Vector2> positions_;
+  std::vector<float> strengths_;
+
+  // It keeps its memory between frames.
+  sf::VertexArray vertices_;
+};
+
+} // End of namespace my_math.
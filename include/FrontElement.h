@@ -10,6 +10,12 @@
 
 namespace my_math
 {
+
+/**
+  \brief Point of front: position, direction and amplitude only. Front elements are drawn by FrontBuffer, and
+         single elements are drawn by one shape shared by all of them, so creating and copying of elements
+         doesn't allocate.
+*/
 class FrontElement : public Element {
  public:
   FrontElement();
@@ -18,17 +24,23 @@ class FrontElement : public Element {
 
   FrontElement(const FrontElement &that);
 
-  FrontElement(FrontElement &&that);
+  FrontElement(FrontElement &&that) noexcept;
 
-  void Swap(FrontElement & that);
+  void Swap(FrontElement & that) noexcept;
 
   FrontElement& operator=(const FrontElement &that);
 
-  FrontElement& operator=(FrontElement &&that);   
+  FrontElement& operator=(FrontElement &&that) noexcept;
 
   bool Draw(sf::RenderWindow & window) override;
 
-  bool DrawColor(sf::RenderWindow & window, float strength);
+
+  /**
+    \brief Get color of front element by field strength. Strength is compared with the greatest strength drawn before.
+    \param[in] strength - Field strength in front element.
+    \return Red color with alpha by strength.
+  */
+  static sf::Color GetStrengthColor(const float strength);
 
   bool Dump() const override;
 
@@ -40,13 +52,10 @@ class FrontElement : public Element {
 
   bool IsOnScreen(const DiffractionGrating *diffraction_grating) const;
 
-  bool SetRGBA(int R, int G, int B, int A);
-
   virtual ~FrontElement();
 
  private:
   float amplitude_;
-  sf::CircleShape circle_shape_;
 };
 
 } // End of namespace my_math.
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Vector2.h"
+#include "DiffractionGrating.h"
+#include "SlotMap.h"
+
+//#define GRATING_GRID_DEBUG 1
+
+namespace my_math
+{
+
+// Side of cell of grid over gratings. Gratings are narrower, so one point has one or two candidates.
+const float GRATING_GRID_STEP = 32.;
+
+
+/**
+  \brief Uniform grid over boxes of diffraction gratings. Every cell keeps indices of gratings which boxes cross it,
+         so collision of point is checked only with gratings of its cell. Grid covers the box of all gratings and is
+         rebuilt when gratings are changed.
+*/
+class GratingGrid {
+ public:
+  GratingGrid(void);
+
+
+  /**
+    \brief Put boxes of gratings into cells.
+    \param[in] diffraction_gratings - All gratings. Indices in cells are indices in its dense array.
+  */
+  void Build(const SlotMap<DiffractionGrating> & diffraction_gratings);
+
+  void Clear(void);
+
+
+  /**
+    \brief Call visit(grating_ind) for every grating which box can cross segment. Gratings of every cell are visited
+           in increasing order, and grating can be visited more than once, if segment crosses several cells.
+    \param[in] begin - The first end of segment.
+    \param[in] end - The second end of segment. It is equal to begin to check point.
+    \param[in] visit - Function to call for indices of gratings.
+  */
+  template <typename Visitor>
+  void VisitCandidates(const Vector2 & begin, const Vector2 & end, Visitor && visit) const
+  {
+    int first_column = 0, last_column = 0, first_row = 0, last_row = 0;
+    if (!GetCells(std::min(begin.GetX( ), end.GetX( )), std::max(begin.GetX( ), end.GetX( )),
+                  std::min(begin.GetY( ), end.GetY( )), std::max(begin.GetY( ), end.GetY( )), &first_column,
+                  &last_column, &first_row, &last_row))
+    {
+      return;
+    }
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+      for (int column = first_column; column <= last_column; column++)
+      {
+        const int cell = row * columns_ + column;
+        for (int ind = cell_starts_[cell]; ind < cell_starts_[cell + 1]; ind++)
+        {
+          visit(grating_indices_[ind]);
+        }
+      }
+    }
+  }
+
+  bool Dump(void) const;
+
+ private:
+  VECTOR_TYPE left_;
+  VECTOR_TYPE top_;
+  int columns_;
+  int rows_;
+
+  // Indices of gratings of cell ind are grating_indices_[cell_starts_[ind], cell_starts_[ind + 1]).
+  std::vector<int> cell_starts_;
+  std::vector<int> grating_indices_;
+
+  /**
+    \breif Give you range of cells which box crosses. Range is clamped by grid.
+    \param[in] left - The least x of box.
+    \param[in] right - The greatest x of box.
+    \param[in] top - The least y of box.
+    \param[in] bottom - The greatest y of box.
+    \param[out] first_column - The first column of range.
+    \param[out] last_column - The last column of range, it is included.
+    \param[out] first_row - The first row of range.
+    \param[out] last_row - The last row of range, it is included.
+    \return True - Box crosses grid. False - box is out of grid, range isn't set.
+  */
+  bool GetCells(const VECTOR_TYPE left, const VECTOR_TYPE right, const VECTOR_TYPE top, const VECTOR_TYPE bottom,
+                int *first_column, int *last_column, int *first_row, int *last_row) const;
+};
+
+} // End of namespace my_math.
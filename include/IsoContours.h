@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2.h"
+#include "DipolePack.h"
+#include "FrontBuffer.h"
+#include "ThreadPool.h"
+
+//#define ISO_CONTOURS_DEBUG 1
+
+namespace my_math
+{
+
+// Distance between nodes of grid of front function.
+const float ISO_CONTOURS_STEP = 4.;
+
+// Cells are extracted by square tiles of ISO_CONTOURS_TILE x ISO_CONTOURS_TILE cells. Every tile is a task of pool.
+const size_t ISO_CONTOURS_TILE = 32;
+
+// Rounding errors of added and subtracted dipoles are accumulated. Grid is rebuilt after so many updates.
+const int ISO_CONTOURS_MAX_UPDATES = 64;
+
+
+/**
+  \brief Fronts of ordinary waves extracted at once as iso-lines of front function of dipoles by marching squares.
+         Front function is the sum of front functions of dipoles, look at DipolePack::GetFrontPhasors( ). Its
+         iso-lines are exact fronts of one dipole, and fronts of many dipoles are approximated as if their angular
+         coefficients were equal. Time-independent parts of it are kept in nodes over the screen and updated only
+         when dipoles are changed, so cost of frame is proportional to number of nodes, not to length of fronts.
+*/
+class IsoContours {
+ public:
+  IsoContours(void);
+
+  IsoContours(const IsoContours & that) = delete;
+
+  IsoContours & operator=(const IsoContours & that) = delete;
+
+
+  /**
+    \brief Compute parts of front function in all nodes.
+    \param[in] dipoles - Dipoles to compute front function of them.
+    \param[in] thread_pool - Pool to compute rows of grid.
+  */
+  void Build(const DipolePack & dipoles, ThreadPool & thread_pool);
+
+
+  /**
+    \brief Add front function of dipoles [first, last) to nodes or subtract it. It costs O(grid) for one dipole.
+           Grid becomes invalid after ISO_CONTOURS_MAX_UPDATES updates to be rebuilt without rounding errors.
+    \param[in] dipoles - Pack with dipoles.
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+    \param[in] sign - 1 - Dipoles were added, -1 - dipoles will be removed.
+    \param[in] thread_pool - Pool to update rows of grid.
+  */
+  void Update(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+              ThreadPool & thread_pool);
+
+  void Invalidate(void);
+
+  bool IsValid(void) const;
+
+
+  /**
+    \brief Extract fronts through positions at time t and add them to front buffer by front elements every
+           FRONT_ELEMENT_STEP. Every front is the iso-line of front function at its level in position, so all fronts
+           are extracted by one pass over cells. Tiles are extracted in parallel and added in order of tiles.
+    \param[in] dipoles - Dipoles of Build( ).
+    \param[in] t - Time from start.
+    \param[in] positions - Points of fronts, e.g. main front elements of waves.
+    \param[in] positions_number - Number of positions.
+    \param[in] thread_pool - Pool to extract tiles.
+    \param[out] front_buffer - Buffer to add front elements.
+  */
+  void Extract(const DipolePack & dipoles, const float t, const Vector2 *positions, const size_t positions_number,
+               ThreadPool & thread_pool, FrontBuffer *front_buffer);
+
+  bool Dump(void) const;
+
+ private:
+  size_t columns_;
+  size_t rows_;
+  bool is_valid_;
+  int updates_number_;
+
+  std::vector<float> in_phase_parts_;
+  std::vector<float> quadrature_parts_;
+
+  // Front function in nodes and sorted levels of fronts at time of the last Extract( ).
+  std::vector<float> values_;
+  std::vector<float> levels_;
+
+  // Front elements of every tile. They keep their memory between frames.
+  std::vector<FrontBuffer> tile_buffers_;
+
+  void AddToNodes(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+                  ThreadPool & thread_pool);
+
+  void ExtractTile(const size_t tile_column, const size_t tile_row, FrontBuffer *front_buffer) const;
+
+  void ExtractCell(const size_t column, const size_t row, FrontBuffer *front_buffer) const;
+
+  // Front elements every FRONT_ELEMENT_STEP along segment of iso-line. Ends are shared with neighbour cells, so
+  // elements are in the middles of equal parts.
+  void PushSegment(const Vector2 & begin, const Vector2 & end, const float strength,
+                   FrontBuffer *front_buffer) const;
+};
+
+} // End of namespace my_math.
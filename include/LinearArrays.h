@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2.h"
+#include "DipolePack.h"
+
+//#define LINEAR_ARRAYS_DEBUG 1
+//#define VERIFY_ARRAY_FACTOR 1
+//#define ARRAY_FACTOR_ERRORS_REPORT 1
+
+namespace my_math
+{
+
+// Shorter runs of dipoles are summed exactly.
+const size_t LINEAR_ARRAY_MIN_DIPOLES = 3;
+
+// Positions, directions and amplitudes of array are compared with this relative accuracy.
+const float LINEAR_ARRAY_EPSILON = 1e-4;
+
+// Phase steps of array are compared with this accuracy in radians.
+const float LINEAR_ARRAY_PHASE_EPSILON = 1e-4;
+
+
+/**
+  \brief Dipoles split in runs of consecutive pushed dipoles. Dipoles of run have the same direction and amplitude,
+         they are equally spaced and have linear progression of phases (uniform linear array).
+         Far field of array is got by closed-form array factor in O(1) for a point. Field is expanded around
+         center of array up to the first order of shifts, so array is used if
+         (half_length * (3 + DISTANCE_PHASE_FACTOR * distance) / (distance - half_length))^2 < tolerance.
+         Other dipoles are summed exactly.
+*/
+class LinearArrays {
+ public:
+  LinearArrays(void);
+
+
+  /**
+    \brief Add the last dipole of pack to the last run or start new run with it.
+    \param[in] dipoles - Pack with new dipole in the end.
+  */
+  void Push(const DipolePack & dipoles);
+
+
+  /**
+    \brief Split all dipoles of pack in runs again. It is used after removing of dipoles.
+    \param[in] dipoles - Pack to split.
+  */
+  void Build(const DipolePack & dipoles);
+
+  void Clear(void);
+
+
+  /**
+    \brief Check that there is run which is long enough to be array.
+  */
+  bool HasArrays(void) const;
+
+
+  /**
+    \brief Get sum of field strengths of all dipoles in point.
+    \param[in] dipoles - Pack which was split in runs.
+    \param[in] point - Point to get field strength in it.
+    \param[in] t - Time from start.
+    \param[in] tolerance - Accuracy of array factor. 0 - all dipoles are summed exactly.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const DipolePack & dipoles, const Vector2 & point, const float t,
+                           const float tolerance) const;
+
+  bool Dump(void) const;
+
+ private:
+  struct LinearArray
+  {
+    // Dipoles of array are [first, last) in pack.
+    size_t first;
+    size_t last;
+
+    float first_x;
+    float first_y;
+    float step_x;
+    float step_y;
+    float direction_x;
+    float direction_y;
+    float amplitude;
+
+    // Phases in radians.
+    float first_phase;
+    float phase_step;
+  };
+
+  std::vector<LinearArray> arrays_;
+
+  void Add(const DipolePack & dipoles, const size_t ind);
+
+  /**
+    \brief Check that dipole continues array.
+    \param[in] linear_array - Array to continue. It has not less than 2 dipoles.
+    \param[in] dipoles - Pack with dipole.
+    \param[in] ind - Index of dipole.
+  */
+  bool IsContinued(const LinearArray & linear_array, const DipolePack & dipoles, const size_t ind) const;
+
+
+  /**
+    \brief Get field strength of array by array factor.
+    \param[out] field_strength - Field strength of array.
+    \return True - Point is far enough for tolerance. False - array should be summed exactly.
+  */
+  bool GetArrayFieldStrength(const LinearArray & linear_array, const Vector2 & point, const float time_phase,
+                             const float tolerance, Vector2 *field_strength) const;
+};
+
+
+/**
+  \brief Compare field of test arrays by array factor with exact sum of their dipoles over region, where points are
+         close to limit of tolerance, and print maximal errors. Arrays have 16 dipoles with step 10 along y, phase
+         step 30 degrees and directions every 15 degrees. Error is relative to
+         (number of dipoles) * amplitude * DISTANT_SCALE / distance, as in VERIFY_ARRAY_FACTOR.
+  \return True - All errors are less than tolerance.
+*/
+bool ReportArrayFactorErrors(void);
+
+} // End of namespace my_math.
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <vector>
+
+#include "Vector2.h"
+#include "DipolePack.h"
+#include "ThreadPool.h"
+
+//#define PHASOR_GRID_DEBUG 1
+
+namespace my_math
+{
+
+// Distance between nodes of grid.
+const float PHASOR_GRID_STEP = 4.;
+
+// Field changes too fast near dipoles to interpolate it. Points nearer to dipoles' box than
+// PHASOR_GRID_STEP * max(PHASOR_GRID_KINK_FACTOR / tolerance, PHASOR_GRID_CURVATURE_FACTOR / sqrt(tolerance))
+// are handled exactly. Look at PhasorGrid::SetTolerance( ).
+const float PHASOR_GRID_KINK_FACTOR = 0.71;
+const float PHASOR_GRID_CURVATURE_FACTOR = 3.;
+
+// Rounding errors of added and subtracted dipoles are accumulated. Grid is rebuilt after so many updates.
+const int PHASOR_GRID_MAX_UPDATES = 64;
+
+
+/**
+  \brief Time-independent parts of dipoles' field in nodes over the screen.
+         All dipoles have CYCLIC_FREQUENCY, so field strength at time t is
+         in_phase_part * cos(CYCLIC_FREQUENCY * t * ONE_RADIAN) + quadrature_part * sin(CYCLIC_FREQUENCY * t * ONE_RADIAN).
+         Grid is rebuilt only when dipoles are changed.
+         Error of interpolation is not more than about tolerance * (sum of amplitudes) * DISTANT_SCALE / distance,
+         as in DipoleTree: |cos| of dipole's angle has kink on its null line, which gives relative error
+         PHASOR_GRID_STEP / (sqrt(2) * distance) in the worst cell, and smooth parts of field give
+         (3 * PHASOR_GRID_STEP / distance)^2.
+*/
+class PhasorGrid {
+ public:
+  PhasorGrid(void);
+
+  PhasorGrid(const PhasorGrid & that) = delete;
+
+  PhasorGrid & operator=(const PhasorGrid & that) = delete;
+
+
+  /**
+    \brief Compute parts of field in all nodes.
+    \param[in] dipoles - Dipoles to compute field of them.
+    \param[in] thread_pool - Pool to compute rows of grid.
+  */
+  void Build(const DipolePack & dipoles, ThreadPool & thread_pool);
+
+
+  /**
+    \brief Add field of dipoles [first, last) to nodes or subtract it. It costs O(grid) for one dipole.
+           Grid becomes invalid after PHASOR_GRID_MAX_UPDATES updates to be rebuilt without rounding errors.
+    \param[in] dipoles - Pack with dipoles.
+    \param[in] first - Index of the first dipole.
+    \param[in] last - Index after the last dipole.
+    \param[in] sign - 1 - Dipoles were added, -1 - dipoles will be removed.
+    \param[in] thread_pool - Pool to update rows of grid.
+  */
+  void Update(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+              ThreadPool & thread_pool);
+
+  /**
+    \brief Set tolerance of interpolation. Distance, on which points near dipoles are excluded, is derived from it.
+           Grid becomes invalid, if distance is changed.
+    \param[in] tolerance - Relative error of field strength. It should be positive.
+  */
+  void SetTolerance(const float tolerance);
+
+  void Invalidate(void);
+
+  bool IsValid(void) const;
+
+
+  /**
+    \brief Set time to get field strength at it.
+    \param[in] t - Time from start.
+  */
+  void SetTime(const float t);
+
+
+  /**
+    \brief Check that field strength in point can be interpolated.
+    \return True - Point is on screen and far from dipoles. False - it isn't.
+  */
+  bool Contains(const Vector2 & point) const;
+
+
+  /**
+    \brief Get field strength in point by bilinear interpolation of nodes.
+    \param[in] point - Point to get field strength in it. Contains(point) should be true.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const Vector2 & point) const;
+
+
+  /**
+    \brief Get field strength in point and derivatives of bilinear interpolation in its cell.
+    \param[in] point - Point to get field strength in it. Contains(point) should be true.
+    \param[out] jacobian - Derivatives of field strength.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const Vector2 & point, FieldJacobian *jacobian) const;
+
+  bool Dump(void) const;
+
+ private:
+  struct Phasor
+  {
+    float in_phase_x;
+    float in_phase_y;
+    float quadrature_x;
+    float quadrature_y;
+  };
+
+  size_t columns_;
+  size_t rows_;
+  bool is_valid_;
+  int updates_number_;
+
+  std::vector<Phasor> nodes_;
+
+  // cos and sin of CYCLIC_FREQUENCY * t * ONE_RADIAN.
+  float time_cos_;
+  float time_sin_;
+
+  // Points nearer to dipoles are excluded. It is derived from tolerance in SetTolerance( ).
+  float excluded_distance_;
+
+  // Box around dipoles, where field isn't interpolated.
+  float excluded_left_;
+  float excluded_right_;
+  float excluded_top_;
+  float excluded_bottom_;
+
+  void AddToNodes(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+                  ThreadPool & thread_pool);
+
+  void ExtendExcludedBox(const Vector2 & position);
+
+  // Field strength in node at time of SetTime( ).
+  Vector2 GetNodeFieldStrength(const size_t ind) const;
+};
+
+} // End of namespace my_math.
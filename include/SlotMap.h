@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace my_math
+{
+
+/**
+  \brief Reference to element of SlotMap or to other slot with generation. It stays valid while element exists, and
+         it is recognized as stale after element is removed, even if its slot is used again.
+*/
+struct SlotHandle
+{
+  uint32_t index;
+  uint32_t generation;
+
+  bool operator==(const SlotHandle & that) const
+  {
+    return index == that.index && generation == that.generation;
+  }
+
+  bool operator!=(const SlotHandle & that) const
+  {
+    return !(*this == that);
+  }
+};
+
+// Handle which refers to nothing.
+const SlotHandle NULL_SLOT_HANDLE = {UINT32_MAX, 0};
+
+
+/**
+  \brief Elements in dense array with stable generational handles. Iteration is over dense array, removal is O(1):
+         the last element takes place of removed one. Slots of removed elements are reused with the next generation.
+         Indices of dense array are changed by removal, handles aren't changed by removal and growth.
+*/
+template <typename T>
+class SlotMap {
+ public:
+  SlotMap(void)
+      :  free_slot_(UINT32_MAX)  {
+  }
+
+
+  /**
+    \brief Add element in the end of dense array.
+    \param[in] value - Element to add.
+    \return Handle of element.
+  */
+  SlotHandle Push(const T & value)
+  {
+    values_.push_back(value);
+    return AddSlot( );
+  }
+
+  SlotHandle Push(T && value)
+  {
+    values_.push_back(std::move(value));
+    return AddSlot( );
+  }
+
+
+  /**
+    \brief Construct element in the end of dense array.
+    \param[in] args - Arguments of constructor of element.
+    \return Handle of element. Element is Back( ).
+  */
+  template <typename... Args>
+  SlotHandle Emplace(Args &&... args)
+  {
+    values_.emplace_back(std::forward<Args>(args)...);
+    return AddSlot( );
+  }
+
+
+  /**
+    \brief Remove element. The last element is moved to its place.
+    \param[in] handle - Handle of element.
+    \return True - Element was removed. False - Handle is stale.
+  */
+  bool Remove(const SlotHandle & handle)
+  {
+    if (!IsValid(handle))
+    {
+      return false;
+    }
+
+    RemoveAt(slot_values_[handle.index]);
+    return true;
+  }
+
+
+  /**
+    \brief Remove element by index in dense array. The last element is moved to its place.
+    \param[in] ind - Index of element in dense array.
+  */
+  void RemoveAt(const size_t ind)
+  {
+    assert(ind < values_.size( ));
+
+    const uint32_t slot = value_slots_[ind];
+    const size_t last_ind = values_.size( ) - 1;
+    if (ind != last_ind)
+    {
+      std::swap(values_[ind], values_[last_ind]);
+      value_slots_[ind] = value_slots_[last_ind];
+      slot_values_[value_slots_[ind]] = ind;
+    }
+
+    FreeSlot(slot);
+    values_.pop_back( );
+    value_slots_.pop_back( );
+    return;
+  }
+
+
+  /**
+    \brief Remove elements [first, Size( )) for which is_removed(ind) is true. Order of other elements is kept.
+    \param[in] first - Index of the first element to check.
+    \param[in] is_removed - Predicate of index of element in dense array before removal.
+  */
+  template <typename Predicate>
+  void RemoveOrdered(const size_t first, Predicate && is_removed)
+  {
+    size_t kept_number = first;
+    for (size_t ind = first; ind < values_.size( ); ind++)
+    {
+      if (is_removed(ind))
+      {
+        FreeSlot(value_slots_[ind]);
+        continue;
+      }
+
+      if (kept_number != ind)
+      {
+        std::swap(values_[kept_number], values_[ind]);
+        value_slots_[kept_number] = value_slots_[ind];
+        slot_values_[value_slots_[kept_number]] = kept_number;
+      }
+      kept_number++;
+    }
+
+    values_.erase(values_.begin( ) + kept_number, values_.end( ));
+    value_slots_.resize(kept_number);
+    return;
+  }
+
+  void Clear(void)
+  {
+    for (const uint32_t slot : value_slots_)
+    {
+      FreeSlot(slot);
+    }
+    values_.clear( );
+    value_slots_.clear( );
+    return;
+  }
+
+  bool IsValid(const SlotHandle & handle) const
+  {
+    return handle.index < slot_generations_.size( ) && slot_generations_[handle.index] == handle.generation &&
+           slot_values_[handle.index] != UINT32_MAX;
+  }
+
+
+  /**
+    \brief Give you element by handle.
+    \return Pointer to element, nullptr if handle is stale.
+  */
+  T * Get(const SlotHandle & handle)
+  {
+    return IsValid(handle) ? &values_[slot_values_[handle.index]] : nullptr;
+  }
+
+  const T * Get(const SlotHandle & handle) const
+  {
+    return IsValid(handle) ? &values_[slot_values_[handle.index]] : nullptr;
+  }
+
+  SlotHandle GetHandle(const size_t ind) const
+  {
+    assert(ind < values_.size( ));
+    return SlotHandle{value_slots_[ind], slot_generations_[value_slots_[ind]]};
+  }
+
+  size_t Size(void) const
+  {
+    return values_.size( );
+  }
+
+  bool Empty(void) const
+  {
+    return values_.empty( );
+  }
+
+  T & operator[](const size_t ind)
+  {
+    return values_[ind];
+  }
+
+  const T & operator[](const size_t ind) const
+  {
+    return values_[ind];
+  }
+
+  T & Back(void)
+  {
+    return values_.back( );
+  }
+
+  typename std::vector<T>::iterator begin(void)
+  {
+    return values_.begin( );
+  }
+
+  typename std::vector<T>::iterator end(void)
+  {
+    return values_.end( );
+  }
+
+  typename std::vector<T>::const_iterator begin(void) const
+  {
+    return values_.begin( );
+  }
+
+  typename std::vector<T>::const_iterator end(void) const
+  {
+    return values_.end( );
+  }
+
+ private:
+  // Elements and slots of them.
+  std::vector<T> values_;
+  std::vector<uint32_t> value_slots_;
+
+  // Index in values_ of element of slot, UINT32_MAX for free slot. Free slots are list by slot_next_free_.
+  std::vector<uint32_t> slot_values_;
+  std::vector<uint32_t> slot_generations_;
+  std::vector<uint32_t> slot_next_free_;
+  uint32_t free_slot_;
+
+  // Give slot to the last element of values_.
+  SlotHandle AddSlot(void)
+  {
+    uint32_t slot = free_slot_;
+    if (slot == UINT32_MAX)
+    {
+      slot = slot_values_.size( );
+      slot_values_.push_back(UINT32_MAX);
+      slot_generations_.push_back(0);
+      slot_next_free_.push_back(UINT32_MAX);
+    }
+    else
+    {
+      free_slot_ = slot_next_free_[slot];
+    }
+
+    slot_values_[slot] = values_.size( ) - 1;
+    value_slots_.push_back(slot);
+    return SlotHandle{slot, slot_generations_[slot]};
+  }
+
+  // Handles of slot become stale.
+  void FreeSlot(const uint32_t slot)
+  {
+    slot_values_[slot] = UINT32_MAX;
+    slot_generations_[slot]++;
+    slot_next_free_[slot] = free_slot_;
+    free_slot_ = slot;
+    return;
+  }
+};
+
+} // End of namespace my_math.
@@ -14,6 +14,20 @@
 
 namespace my_math
 {
+
+/**
+  \brief Spatial derivatives of field strength in point. They give curvature of front line.
+*/
+struct FieldJacobian
+{
+  // Derivative of field strength along x axis.
+  Vector2 x_derivative;
+
+  // Derivative of field strength along y axis.
+  Vector2 y_derivative;
+};
+
+
 class Source : public Element {
  public:
   Source(void);
@@ -22,7 +36,7 @@ class Source : public Element {
 
   Source(const Source & that);
 
-  Source(Source && that);
+  Source(Source && that) noexcept;
 
   virtual bool Draw(sf::RenderWindow & window) = 0;
 
@@ -55,7 +69,13 @@ class Dipole : public Source {
 
   Dipole(const Dipole & that);
 
-  Dipole(Dipole && that);
+  Dipole(Dipole && that) noexcept;
+
+  void Swap(Dipole & that) noexcept;
+
+  Dipole & operator=(const Dipole & that);
+
+  Dipole & operator=(Dipole && that) noexcept;
 
   bool Draw(sf::RenderWindow & window) override;
 
@@ -89,24 +109,44 @@ class SecondarySource : public Source {
 
   SecondarySource(const SecondarySource & that);
 
-  SecondarySource(SecondarySource && that);
+  SecondarySource(SecondarySource && that) noexcept;
 
-  void Swap(SecondarySource & that);
+  void Swap(SecondarySource & that) noexcept;
 
   SecondarySource & operator=(const SecondarySource & that);
 
-  SecondarySource & operator=(SecondarySource && that);
+  SecondarySource & operator=(SecondarySource && that) noexcept;
  
   bool Draw(sf::RenderWindow & window) override;
 
   bool Dump() const override;
 
-  // get field strength from this source in point
-  Vector2 GetFieldStrength(const Vector2 & point, const float t, const std::vector<Dipole> &dipoles_) const;
+  /**
+    \brief Get field strength from this source in point. It uses field of dipoles which was set by
+           SetBaseFieldStrength( ), so t isn't used.
+    \param[in] point - Point to get field strength in it.
+    \param[in] t - Time from start.
+  */
+  virtual Vector2 GetFieldStrength(const Vector2 & point, const float t) const override;
+
+
+  /**
+    \brief Save field of dipoles in position of this source. It should be set once per time step.
+    \param[in] base_field_strength - Field strength of dipoles in position of this source.
+  */
+  void SetBaseFieldStrength(const Vector2 & base_field_strength);
+
+
+  /**
+    \brief Give you S * |base field strength| / (2 * lambda). Field strength of this source is
+           factor * (1 + cos(alpha)) * cos(k * r) / r along rotated by 90 radius vector.
+  */
+  float GetRadiationFactor(void) const;
 
   ~SecondarySource();
 
  private:
+  // Length of field strength of dipoles in position of this source.
   float field_strength_;
 
   // Square of secondary source's area.
@@ -7,6 +7,15 @@
 #include "Sources.h"
 #include "DipoleArea.h"
 #include "DiffractionGrating.h"
+#include "ThreadPool.h"
+#include "DipolePack.h"
+#include "PhasorGrid.h"
+#include "DipoleTree.h"
+#include "LinearArrays.h"
+#include "FrontBuffer.h"
+#include "IsoContours.h"
+#include "GratingGrid.h"
+#include "SlotMap.h"
 
 //#define STORE_DEBUG 1
 //#define STORE_DRAW_DEBUG 1
@@ -14,20 +23,73 @@
 //#define STOP_WAVES 1
 #define USING_DIFFRACTION_GRATING 1
 #define DRAW_ALL_FRONT_ELEMENTS 1
+#define USING_PHASOR_GRID 1
+#define USING_DIPOLE_TREE 1
+#define USING_LINEAR_ARRAYS 1
+#define USING_PATH_PHASORS 1
+#define USING_WARM_FRONTS 1
 //#define MEMORY_LEAKS_DEBUG 1
 //#define COLLISION_DEBAG 1
-//#define DRAW_STEP_BY_STEP 1
 
 class Store {
  public:
-  Store();
+  /**
+    \brief Create store and its thread pool.
+    \param[in] threads_number - Number of threads to handle waves and dipoles. 0 - all hardware threads.
+    \param[in] pin_threads - True - pin every thread of the pool to its own CPU.
+  */
+  explicit Store(const unsigned int threads_number = DEFAULT_THREADS_NUMBER,
+                 const bool pin_threads = DEFAULT_THREADS_PINNING);
 
   bool Push(const Dipole & dipole);
 
   bool Push(const Wave & wave);
 
+  bool Push(Wave && wave);
+
   bool Push(const DiffractionGrating & diffraction_grating);
 
+  bool Push(DiffractionGrating && diffraction_grating);
+
+  /**
+    \brief Remove dipole from store.
+    \param[in] ind - Index of dipole in order of pushing.
+    \return True - Dipole was removed. False - there is no dipole with such index.
+  */
+  bool RemoveDipole(const size_t ind);
+
+  size_t GetDipolesNumber(void) const;
+
+
+  /**
+    \brief Set accuracy of dipoles' field out of phasor grid.
+    \param[in] tolerance - Relative error of every collapsed cluster of dipoles or linear array. 0 - field is summed
+                            exactly.
+  */
+  void SetFieldTolerance(const float tolerance);
+
+  float GetFieldTolerance(void) const;
+
+
+  /**
+    \brief Set accuracy of tracing of fronts.
+    \param[in] tolerance - The largest deviation of every step of front from exact front line in pixels.
+  */
+  void SetFrontTolerance(const float tolerance);
+
+  float GetFrontTolerance(void) const;
+
+
+  /**
+    \brief Set the way to draw fronts of ordinary waves.
+    \param[in] is_contour_fronts - True - all fronts are extracted at once as iso-lines of front function of dipoles.
+                                   Ordinary waves don't collide with diffraction gratings then.
+                                   False - every front is traced from its main element.
+  */
+  void SetContourFronts(const bool is_contour_fronts);
+
+  bool IsContourFronts(void) const;
+
   bool Draw(sf::RenderWindow & window);
 
   bool Dump() const;
@@ -43,72 +105,368 @@ class Store {
 
   bool Clear();
 
-  Vector2 GetFieldStrength(const my_math::Vector2 & position, const DiffractionGrating *diffraction_grating = nullptr) const;
+  /**
+    \brief Get field strength in point.
+    \param[in] position - Point to get field strength in it.
+    \param[in] diffraction_grating - Grating to get field of its secondary sources. nullptr - field of dipoles.
+    \param[in, out] path - Path of dipoles' phasors to sum dipoles exactly along traced line. nullptr - no path.
+    \return Field strength.
+  */
+  Vector2 GetFieldStrength(const my_math::Vector2 & position, const DiffractionGrating *diffraction_grating = nullptr,
+                           my_math::PathPhasors *path = nullptr) const;
+
+
+  /**
+    \brief Get field strength in point and its spatial derivatives in one pass over sources.
+    \param[in] position - Point to get field strength in it.
+    \param[in] diffraction_grating - Grating to get field of its secondary sources. nullptr - field of dipoles.
+    \param[out] field_strength - Field strength.
+    \param[out] jacobian - Derivatives of field strength.
+    \param[in, out] path - Path of dipoles' phasors to sum dipoles exactly along traced line. nullptr - no path.
+    \return True - Derivatives are got. False - field is approximated by dipole_tree_ or linear_arrays_ and only
+            field strength is got.
+  */
+  bool GetFieldStrength(const my_math::Vector2 & position, const DiffractionGrating *diffraction_grating,
+                        my_math::Vector2 *field_strength, FieldJacobian *jacobian,
+                        my_math::PathPhasors *path = nullptr) const;
+
+
+  /**
+    \brief Get field strengths in many points at once. Points are handled by tiles in thread_pool_.
+    \param[in] positions - Array of points.
+    \param[out] field_strengths - Array to write field strengths in it.
+    \param[in] points_number - Number of points.
+    \param[in] diffraction_grating - Grating to get field of its secondary sources. nullptr - field of dipoles.
+  */
+  void GetFieldStrength(const my_math::Vector2 *positions, my_math::Vector2 *field_strengths,
+                        const size_t points_number, const DiffractionGrating *diffraction_grating = nullptr) const;
 
   ~Store();
 
  private:
   std::vector<Dipole> dipoles_;
-  std::vector<Wave> waves_;
-  std::vector<DiffractionGrating> diffraction_gratings_;
+
+  // Copy of dipoles_ for vectorized field summation. It is changed with dipoles_.
+  DipolePack dipole_pack_;
+
+  // Field of dipoles over the screen. It is rebuilt after changes of dipoles_.
+  PhasorGrid phasor_grid_;
+
+  // Front elements of all waves of the current frame. They are drawn by one call in the end of Draw( ).
+  FrontBuffer front_buffer_;
+
+  // Collision of wave with diffraction grating. It is applied to waves_ after all waves of pass are traced.
+  struct WaveCollision
+  {
+    // Index of grating in diffraction_gratings_.
+    int grating_ind;
+    Vector2 position;
+
+    // Normed field strength in position.
+    Vector2 front_direction;
+
+    // True - main front element collided. False - element of top or bottom part.
+    bool is_main_element;
+    bool is_top_part;
+  };
+
+  // Kinds of changes of waves_ caused by collisions.
+  enum COLLISION_EVENT_TYPES
+  {
+    SPAWN_EVENT = 0, ///< Secondary source is created in slot of grating and its secondary wave is pushed.
+    SPLIT_EVENT = 1, ///< Part of collided ordinary wave is pushed.
+  };
+
+  // Change of waves_ caused by collision. Events of pass are queued in order of waves and resolved by one batch.
+  struct CollisionEvent
+  {
+    COLLISION_EVENT_TYPES type;
+
+    // Index of grating in diffraction_gratings_ for spawn event.
+    int grating_ind;
+
+    // Point of collision for spawn event, main front element of part for split event.
+    Vector2 position;
+
+    // Drawn sides of part for split event.
+    DRAWN_SIDES drawn_sides;
+  };
+
+  // Result of tracing of one half of wave in pass. Half is traced until its first collision.
+  struct WaveTrace
+  {
+    FrontBuffer front_buffer;
+
+    // Knots of traced half. They are the warm start of the next frame.
+    FrontPath front_path;
+    bool is_collided;
+    WaveCollision collision;
+  };
+
+  // Traces of halves of waves of the current pass: top half of wave ind is 2 * ind, bottom half is 2 * ind + 1.
+  // They keep their memory between frames.
+  std::vector<WaveTrace> wave_traces_;
+
+  // Events of collisions of the current pass. It keeps its memory between passes.
+  std::vector<CollisionEvent> collision_events_;
+
+  // Number of first dipoles in dipole_pack_, which field is in phasor_grid_. Others will be added in UpdatePhasorGrid.
+  size_t phasor_grid_dipoles_number_;
+
+  // Quadtree over dipoles for points out of phasor_grid_. It is rebuilt after changes of dipoles_.
+  DipoleTree dipole_tree_;
+
+  // Uniform linear arrays among dipoles_. Their far field is got by array factor.
+  LinearArrays linear_arrays_;
+
+  // Front function of dipoles over the screen.
+  IsoContours iso_contours_;
+
+  // Number of first dipoles in dipole_pack_, which front function is in iso_contours_. Others will be added in
+  // DrawContourFronts.
+  size_t iso_contours_dipoles_number_;
+
+  bool is_contour_fronts_;
+  float field_tolerance_;
+  float front_tolerance_;
+
+  // Waves refer to gratings and their secondary sources by handles, so gratings can be added while waves exist.
+  SlotMap<Wave> waves_;
+  SlotMap<DiffractionGrating> diffraction_gratings_;
+
+  // Cells over boxes of diffraction_gratings_ for CheckCollisions( ). It is rebuilt after changes of gratings.
+  GratingGrid grating_grid_;
   DipoleArea dipole_area_;
 
+  // Buffers for batch of main front elements in MoveWaves( ) and DrawContourFronts( ).
+  std::vector<Vector2> main_positions_;
+  std::vector<Vector2> main_field_strengths_;
+
+  // It is created once. Field sums and wave moves are executed by it.
+  mutable ThreadPool thread_pool_;
+
   float t;
   float time_from_start;
 
+  // Point of front line with unit tangent of front and field strength in it.
+  struct FrontKnot
+  {
+    Vector2 position;
+    Vector2 direction;
+    float strength;
+
+    // Signed curvature of front line: positive - direction turns counterclockwise in axes of screen.
+    float curvature;
+    bool is_curvature_known;
+  };
+
   /**
-      \breif Check front_element on collision with diffraction_grating.
-      \param[in] position - Position to check collisions with it.
+      \breif Check segment of front element's path on collision with box of diffraction_grating.
+      \param[in] begin - The first end of segment.
+      \param[in] end - The second end of segment. It is equal to begin to check point.
       \param[in] diffraction_grating - Diffraction grating to check collisions wit it.
+      \param[out] part - Part of segment from begin to the first point in box.
       \return True - Collision happened. False - collision didn't happen.
   */
-  bool IsCollisions(const Vector2 & position, const DiffractionGrating & diffraction_grating) const;
+  bool IsCollisions(const Vector2 & begin, const Vector2 & end, const DiffractionGrating & diffraction_grating,
+                    float *part) const;
+
+  bool MoveWave(Wave & wave, const Vector2 & field_strength);
 
-  bool MoveWave(Wave & wave);
+
+  /**
+    \breif Rebuild phasor_grid_ or add new dipoles to it. It should be called before field strength is used.
+  */
+  void UpdatePhasorGrid(void);
 
 
   /**
-    \breif Handle all waves' collisions with diffraction gratings and draw all waves.
-    \param[in] window - Window to draw all waves.
-    \return True - Collisions weren't happened, False - collisions were happened. 
+    \breif Rebuild dipole_tree_ if dipoles were changed. It should be called before field strength is used.
   */
-  bool HandleAllWaves(sf::RenderWindow & window);
+  void UpdateDipoleTree(void);
 
 
   /**
-      \breif Check front element on collisions with difraction gratings.
-      \param[in] front_element - Front element to check collisions.
+    \breif Extract fronts of all ordinary waves into front_buffer_ as iso-lines through their main elements.
+  */
+  void DrawContourFronts(void);
+
+
+  /**
+    \breif Give you grating of secondary wave.
+    \param[in] wave - Wave.
+    \return Grating, nullptr for ordinary wave.
+  */
+  const DiffractionGrating * GetDiffractionGrating(const Wave & wave) const;
+
+
+  /**
+    \breif Check that field of dipoles is got by dipole_tree_.
+    \return True - There are many dipoles and tolerance isn't 0. False - field is summed exactly.
+  */
+  bool IsDipoleTreeUsed(void) const;
+
+
+  /**
+    \breif Check that field of dipoles in position is interpolated by phasor_grid_.
+    \param[in] position - Point to get field strength in it.
+    \return True - Tolerance isn't 0 and point is on grid far from dipoles. False - it isn't.
+  */
+  bool IsPhasorGridUsed(const Vector2 & position) const;
+
+
+  /**
+    \breif Check that field of dipoles is got by dipole_tree_ or linear_arrays_.
+  */
+  bool IsFieldApproximated(void) const;
+
+
+  /**
+    \breif Get field strength of dipoles by dipole_tree_ or linear_arrays_ with field_tolerance_.
+    \param[in] position - Point to get field strength in it.
+    \return Field strength.
+  */
+  Vector2 GetApproximateFieldStrength(const Vector2 & position) const;
+
+
+  /**
+    \breif Trace waves [first_wave, end) in parallel, add their front elements to front_buffer_ and apply their
+           collisions. Collided waves are removed, their parts and secondary waves are pushed in the end.
+    \param[in] first_wave - Index of the first wave which wasn't traced in this frame.
+    \return Index of the first new wave. All waves are traced, if it is waves_.Size( ).
+  */
+  size_t HandleWaves(const size_t first_wave);
+
+
+  /**
+      \breif Check segment of front element's path on collisions with difraction gratings.
+      \param[in] begin - Previous position of front element.
+      \param[in] end - Next position of front element. It is equal to begin to check point.
+      \param[in] wave_status - Status of wave. Only ordinary waves collide.
+      \param[out] grating_ind - Index of grating in diffraction_gratings_, if collision was happened.
+      \param[out] position - The first point of segment in grating, if collision was happened.
       \return True - Collision wasn't happened. False - Collision was happened.
   */
-  bool CheckCollisions(const FrontElement & front_element, const WAVE_STATUSES wave_status);
+  bool CheckCollisions(const Vector2 & begin, const Vector2 & end, const WAVE_STATUSES wave_status,
+                       int *grating_ind, Vector2 *position) const;
+
+
+  /**
+      \breif Add secondary source of grating in point of collision and push its secondary wave.
+      \param[in] grating_ind - Index of grating in diffraction_gratings_.
+      \param[in] position - Point of collision.
+      \return True - Secondary source was created. Its base field strength should be updated.
+  */
+  bool HandleGratingCollision(const int grating_ind, const Vector2 & position);
+
+
+  /**
+      \breif Queue events of collided wave: secondary source in grating and parts of wave. The wave isn't changed.
+      \param[in] wave_ind - Index wave in waves_.
+      \param[in] collision - Collision found by HandleWave( ).
+  */
+  void QueueCollision(const int wave_ind, const WaveCollision & collision);
+
+
+  /**
+      \breif Apply all queued events in order of queue. Waves are pushed in the end of waves_, and base field
+             strengths are updated once for every grating with new secondary sources.
+  */
+  void ResolveCollisionEvents(void);
+
+
+  /**
+      \breif Trace a part of wave into trace. Front path of the last frame is corrected knot by knot, and front line
+             is traced again from the first knot which isn't corrected.
+      \param[in] main_front_element_position - Start position to trace.
+      \param[in] wave_ind - Index wave in waves_.
+      \param[out] trace - Trace to add front elements and collision of wave.
+      \return False - Collision with difraction gratings was happened. True - it wasn't happened.
+  */
+  bool DrawHalfWave(const Vector2 & main_front_element_position, const bool is_top_part, const int wave_ind,
+                    WaveTrace *trace) const;
+
+
+  /**
+      \breif Get knot of front line in point. Direction is rotated to the drawn side of wave.
+      \param[in] position - Point of front line.
+      \param[in] is_top_part - True - top part of wave is drawn.
+      \param[in] wave_ind - Index wave in waves_.
+      \param[in, out] path - Phasors of dipoles on front line. Look at DipolePack::StartPath( ).
+      \param[in] is_curvature_needed - True - get curvature by derivatives of field strength.
+      \return Knot. Direction is zero if there is no field.
+  */
+  FrontKnot GetFrontKnot(const Vector2 & position, const bool is_top_part, const int wave_ind, PathPhasors *path,
+                         const bool is_curvature_needed = false) const;
+
+
+  /**
+      \breif Give length of the first step of Bogacki-Shampine method from knot.
+      \param[in] knot - Start of front line.
+      \return Length of step.
+  */
+  float GetFirstFrontStep(const FrontKnot & knot) const;
+
+
+  /**
+      \breif Correct knot of the last frame onto front line. Chord from knot to the next one bisects their tangents as
+             on arc of circle, and its length is kept. Position is iterated until it moves less than front_tolerance_.
+      \param[in] knot - Start of step on front line. It corresponds to the knot old_ind - 1 of old_path.
+      \param[in] old_path - Front path of the last frame.
+      \param[in] old_ind - Index of knot in old_path to correct.
+      \param[in] is_top_part - True - top part of wave is drawn.
+      \param[in] wave_ind - Index wave in waves_.
+      \param[in, out] path - Phasors of dipoles on front line.
+      \param[out] next_knot - Corrected knot. Its curvature isn't known. If its direction is opposite to direction
+                             of knot, front line flips and it isn't corrected.
+      \return Length of chord. 0 - correction didn't converge.
+  */
+  float CorrectFrontStep(const FrontKnot & knot, const FrontPath & old_path, const size_t old_ind,
+                         const bool is_top_part, const int wave_ind, PathPhasors *path, FrontKnot *next_knot) const;
 
 
   /**
-      \breif Draw a part of wave.
-      \param[out] window - Window to draw wave.
-      \param[in] main_front_element_position - Start position to draw.
+      \breif Take one step of Bogacki-Shampine method along front line. Step is repeated with shorter length until
+             its error is less than front_tolerance_ or length is FRONT_ELEMENT_STEP. Length of the next step is
+             limited by curvature in the end of step. Look at GetFrontTurnLength( ).
+      \param[in] knot - Start of step.
+      \param[in] is_top_part - True - top part of wave is drawn.
       \param[in] wave_ind - Index wave in waves_.
-      \return Value with no sense.
+      \param[in, out] path - Phasors of dipoles on front line.
+      \param[in, out] step - Length of step to try. It is set to length of the next step.
+      \param[out] next_knot - End of step.
+      \return Length of taken step.
+  */
+  float TakeFrontStep(const FrontKnot & knot, const bool is_top_part, const int wave_ind, PathPhasors *path,
+                      float *step, FrontKnot *next_knot) const;
+
+
+  /**
+      \breif Get length of front line, on which direction turns by MAX_FRONT_TURN or becomes parallel to x axis.
+             Drawn side flips on x axis, so step shouldn't cross it.
+      \param[in] knot - Knot with known curvature.
+      \return Length. It is MAX_FRONT_STEP for straight front line.
   */
-  bool DrawHalfWave(sf::RenderWindow & window, const Vector2 & main_front_element_position, const bool is_top_part,
-                    const int wave_ind);
+  float GetFrontTurnLength(const FrontKnot & knot) const;
 
 
   /**
-      \breif It necessary to split wave. Push one of splited wave's parts in waves_.
+      \breif It necessary to split wave. Queue split event of one of splited wave's parts.
       \param[in] position - Position to create new part of wave.
       \param[in] direction - Direction of wave's main front element.
       \param[in] factor - It is 1 if you want to create top part of wave and (-1) if you want to create bottom part.
   */
-  void PushWaveMainElement(const Vector2 & position, Vector2 & direction, const signed char factor);
+  void QueueWavePart(const Vector2 & position, Vector2 & direction, const signed char factor);
 
 
   /**
-      \breif Draw wave and check it on collisions.
-      \param[out] window - Window to draw wave.
-      \param[out] wave - Wave to draw it on window.
+      \breif Trace half of wave and check it on collisions. It only reads store, so halves are traced in parallel.
+             Main front element is added to trace of top half. Bottom half is traced even if top half collides,
+             HandleWaves( ) drops it then.
       \param[in] wave_ind - Index wave in waves_.
+      \param[in] is_top_part - True - top half of wave is traced.
+      \param[out] trace - Trace to add front elements and collision of half.
       \return False - Collision with difraction gratings was happened. True - it wasn't happened.
   */ 
-  bool HandleWave(sf::RenderWindow & window, Wave &wave, const int wave_ind);
+  bool HandleWave(const int wave_ind, const bool is_top_part, WaveTrace *trace) const;
 };
\ No newline at end of file
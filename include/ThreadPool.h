@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//#define THREAD_POOL_DEBUG 1
+
+namespace my_math
+{
+
+class ThreadPool {
+ public:
+  /**
+    \brief Create workers once. They sleep until ParallelFor gives them work.
+    \param[in] threads_number - Number of threads which execute tasks (caller thread is counted too).
+                                0 - use std::thread::hardware_concurrency( ).
+    \param[in] pin_threads - True - pin every worker to its own CPU.
+  */
+  explicit ThreadPool(const unsigned int threads_number = 0, const bool pin_threads = false);
+
+  ThreadPool(const ThreadPool & that) = delete;
+
+  ThreadPool & operator=(const ThreadPool & that) = delete;
+
+  ~ThreadPool( );
+
+
+  /**
+    \brief Split [0, count) into chunks and execute func(begin, end) for every chunk.
+           Every thread starts with its own equal range of chunks and takes them from the front. Thread which has
+           done its range steals the back half of the range of another thread, so chunks of different cost are
+           balanced without a shared counter. Caller thread executes chunks too and returns when all chunks are done.
+           Call from a task of this pool is executed in the calling thread.
+    \param[in] count - Number of elements.
+    \param[in] chunk_size - Number of elements in one chunk.
+    \param[in] func - Function to execute for every chunk.
+  */
+  template <typename Func>
+  void ParallelFor(const size_t count, const size_t chunk_size, Func && func)
+  {
+    // Function is passed without std::function to avoid heap allocation on every call.
+    Run(count, chunk_size, &InvokeChunk<typename std::remove_reference<Func>::type>,
+        const_cast<void *>(static_cast<const void *>(&func)));
+  }
+
+
+  /**
+    \breif Give you number of threads which execute tasks.
+    \return Number of workers plus caller thread.
+  */
+  unsigned int GetThreadsNumber(void) const;
+
+ private:
+  typedef void (*ChunkFunction)(void *context, const size_t begin, const size_t end);
+
+  template <typename Func>
+  static void InvokeChunk(void *context, const size_t begin, const size_t end)
+  {
+    (*static_cast<Func *>(context))(begin, end);
+  }
+
+  // Range [begin, end) of chunks which aren't taken yet. begin is in high half of word and end is in low half, so
+  // owner and thieves change both of them by one compare and swap. Every range has its own cache line.
+  struct alignas(64) ChunkRange {
+    std::atomic<uint64_t> range;
+  };
+
+  std::vector<std::thread> workers_;
+
+  // Range of thread ind. Caller thread is 0, worker ind is ind.
+  std::vector<ChunkRange> ranges_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_condition_;
+  std::condition_variable done_condition_;
+  bool is_stopped_;
+
+  // Current job. It is changed only under mutex_ when there is no busy worker.
+  ChunkFunction job_;
+  void *job_context_;
+  size_t job_count_;
+  size_t job_chunk_size_;
+  size_t job_chunks_number_;
+  unsigned long job_generation_;
+  std::atomic<size_t> remaining_chunks_;
+  unsigned int busy_workers_;
+
+  void Run(const size_t count, const size_t chunk_size, const ChunkFunction func, void *context);
+
+  void WorkerLoop(const unsigned int worker_ind);
+
+  void RunChunks(const unsigned int thread_ind);
+
+  void RunChunk(const size_t chunk);
+
+  bool PopChunk(const unsigned int thread_ind, size_t *chunk);
+
+  bool StealChunk(const unsigned int thread_ind, size_t *chunk);
+
+  void PinThread(std::thread & thread, const unsigned int cpu_ind);
+};
+
+} // End of namespace my_math.
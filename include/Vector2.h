@@ -1,6 +1,7 @@
 #pragma once
 #include <iostream>
 #include <cmath>
+#include <type_traits>
 
 #include <SFML/Graphics.hpp>
 
@@ -11,41 +12,117 @@ const float ONE_RADIAN = PI / 180;
 const float ZERO_VECTOR = -1;
 typedef float VECTOR_TYPE;
 
+
+/**
+  \brief Precomputed matrix of rotation by angle. Rotation by the same angle many times costs one cos and one sin.
+         Multiples of 90 degrees give exact 0, 1 and -1.
+*/
+class Rotation2 {
+ public:
+  /**
+    \brief Matrix of rotation.
+    \param[in] degree - Angle in degrees, counterclockwise in axes of vector.
+  */
+  explicit Rotation2(const VECTOR_TYPE degree);
+
+  constexpr Rotation2(const VECTOR_TYPE cos_angle, const VECTOR_TYPE sin_angle)
+      :  cos_(cos_angle),
+         sin_(sin_angle) {
+  }
+
+  constexpr VECTOR_TYPE GetCos(void) const {
+    return cos_;
+  }
+
+  constexpr VECTOR_TYPE GetSin(void) const {
+    return sin_;
+  }
+
+ private:
+  VECTOR_TYPE cos_;
+  VECTOR_TYPE sin_;
+};
+
+
+/**
+  \brief Core of vector. It has no virtual functions, so it is 8 bytes of x and y, and arrays of vectors are
+         arrays of interleaved x and y. They can be loaded directly as SIMD lanes.
+*/
 class KernelVector2 {
  public:
   // Base functions.
-  KernelVector2(void);
-
-  KernelVector2(VECTOR_TYPE  x, VECTOR_TYPE  y);
+  constexpr KernelVector2(void)
+      :  x_(0),
+         y_(0) {
+  }
 
-  virtual ~KernelVector2(void) {
+  constexpr KernelVector2(VECTOR_TYPE  x, VECTOR_TYPE  y)
+      :  x_(x),
+         y_(y) {
   }
 
-  KernelVector2(const KernelVector2 & that);
+  KernelVector2(const KernelVector2 & that) = default;
 
-  KernelVector2(KernelVector2 && that);
+  KernelVector2(KernelVector2 && that) = default;
 
-  KernelVector2(const sf::Vector2i & vect);
+  KernelVector2(const sf::Vector2i & vect)
+      :  x_(vect.x),
+         y_(vect.y) {
+  }
 
-  KernelVector2(const sf::Vector2f & vect);
+  constexpr KernelVector2(const sf::Vector2f & vect)
+      :  x_(vect.x),
+         y_(vect.y) {
+  }
 
-  KernelVector2 & operator=(const KernelVector2 & vect);
-  KernelVector2 & operator=(const KernelVector2 && vect);
+  KernelVector2 & operator=(const KernelVector2 & vect) = default;
+  KernelVector2 & operator=(KernelVector2 && vect) = default;
   void Dump(void) const;
   // Interface functions.
 
   // Just adding vectors.
-  KernelVector2 & operator+=(const KernelVector2 & vect);
+  KernelVector2 & operator+=(const KernelVector2 & vect) {
+    x_ += vect.x_;
+    y_ += vect.y_;
+    return *this;
+  }
 
   // Multiply by k.
-  KernelVector2 & operator*=(const VECTOR_TYPE  k);
+  KernelVector2 & operator*=(const VECTOR_TYPE  k) {
+    x_ *= k;
+    y_ *= k;
+    return *this;
+  }
 
   // Additional functions.
-  VECTOR_TYPE  Len(void) const;
-  void Reset(const VECTOR_TYPE  x, const VECTOR_TYPE  y);
+  VECTOR_TYPE  Len(void) const {
+    return sqrt(x_ * x_ + y_ * y_);
+  }
+
+  void Reset(const VECTOR_TYPE  x, const VECTOR_TYPE  y) {
+    x_ = x;
+    y_ = y;
+    return;
+  }
+
+  // Rotate counterclockwise in axes of vector. Multiples of 90 degrees are exact swizzles.
   void Rotate(const VECTOR_TYPE  degree);
-  float GetX(void) const;
-  float GetY(void) const;
+
+  void Rotate(const Rotation2 & rotation) {
+    const VECTOR_TYPE x = x_;
+    x_ = rotation.GetCos( ) * x - rotation.GetSin( ) * y_;
+    y_ = rotation.GetSin( ) * x + rotation.GetCos( ) * y_;
+    return;
+  }
+
+  constexpr float GetX(void) const {
+    return x_;
+  }
+
+  constexpr float GetY(void) const {
+    return y_;
+  }
+
  protected:
   VECTOR_TYPE  x_;
   VECTOR_TYPE  y_;
@@ -56,57 +133,82 @@ class KernelVector2 {
 class Vector2 : public KernelVector2 {
  public:
   // Base functions.
-  Vector2(void) 
+  constexpr Vector2(void)
       : KernelVector2( ) {
   }
 
-  Vector2(VECTOR_TYPE  x, VECTOR_TYPE  y)
+  constexpr Vector2(VECTOR_TYPE  x, VECTOR_TYPE  y)
       :  KernelVector2(x, y) {
   }
 
-  ~Vector2(void) {
-  }
-
-  Vector2(const Vector2 & vect) 
-      :  KernelVector2(vect) {
-  }
+  Vector2(const Vector2 & vect) = default;
 
-  Vector2(Vector2 && vect) 
-      :  KernelVector2(vect) {
-  }
+  Vector2(Vector2 && vect) = default;
 
   Vector2(const sf::Vector2i & vect)
       : KernelVector2(vect) {
   }
 
-  Vector2(const sf::Vector2f & vect)
+  constexpr Vector2(const sf::Vector2f & vect)
       : KernelVector2(vect) {
   }
 
-  Vector2 & operator=(const Vector2 & vect);
+  Vector2 & operator=(const Vector2 & vect) = default;
+  Vector2 & operator=(Vector2 && vect) = default;
 
   // Just adding vectors.
-  Vector2 operator+(const Vector2 & vect) const;
+  constexpr Vector2 operator+(const Vector2 & vect) const {
+    return Vector2(x_ + vect.x_, y_ + vect.y_);
+  }
 
-  // Just subtracting vectors. 
-  Vector2 & operator-=(const Vector2 & vect);
-  Vector2 operator-(const Vector2 & vect) const;
+  // Just subtracting vectors.
+  Vector2 & operator-=(const Vector2 & vect) {
+    x_ -= vect.x_;
+    y_ -= vect.y_;
+    return *this;
+  }
+
+  constexpr Vector2 operator-(const Vector2 & vect) const {
+    return Vector2(x_ - vect.x_, y_ - vect.y_);
+  }
 
   // Multiply by -1.
-  Vector2 operator-(void) const;
+  constexpr Vector2 operator-(void) const {
+    return Vector2(-x_, -y_);
+  }
 
   // Multiply by k.
-  Vector2 operator*(const VECTOR_TYPE  k) const;
+  constexpr Vector2 operator*(const VECTOR_TYPE  k) const {
+    return Vector2(x_ * k, y_ * k);
+  }
 
   // Division by k. Situation 0 / 0 and (const != 0) / 0 is correct, but poison vector.
-  Vector2 operator/(const VECTOR_TYPE  k) const;
+  constexpr Vector2 operator/(const VECTOR_TYPE  k) const {
+    return Vector2(x_ * (1 / k), y_ * (1 / k));
+  }
 
   // Additional functions.
-  VECTOR_TYPE  SquareLen(void) const;
+  constexpr VECTOR_TYPE  SquareLen(void) const {
+    return x_ * x_ + y_ * y_;
+  }
 
   // Return rotated vector.
   Vector2 GetRotated(const VECTOR_TYPE degree) const;
 
+  constexpr Vector2 GetRotated(const Rotation2 & rotation) const {
+    return Vector2(rotation.GetCos( ) * x_ - rotation.GetSin( ) * y_,
+                   rotation.GetSin( ) * x_ + rotation.GetCos( ) * y_);
+  }
+
+  // Exact rotations by 90 and -90 degrees.
+  constexpr Vector2 GetRotated90(void) const {
+    return Vector2(-y_, x_);
+  }
+
+  constexpr Vector2 GetRotatedMinus90(void) const {
+    return Vector2(y_, -x_);
+  }
+
   // Get Rotation from hour zero (clockwise rotation).
   float GetClockwiseRotation(int* code_error) const;
 
@@ -114,7 +216,9 @@ class Vector2 : public KernelVector2 {
   void Norm(void);
 
   // Scalar muliplication
-  float operator*(const Vector2& other) const;
+  constexpr float operator*(const Vector2& other) const {
+    return x_ * other.x_ + y_ * other.y_;
+  }
 
   float GetCosAngleBetweenVectors(const Vector2 & b) const;
 
@@ -124,6 +228,12 @@ class Vector2 : public KernelVector2 {
 };
 
 // Addition to override operators.
-Vector2 operator*(const VECTOR_TYPE k, const Vector2 & vect);
+constexpr Vector2 operator*(const VECTOR_TYPE k, const Vector2 & vect)
+{
+  return vect * k;
+}
+
+static_assert(sizeof(Vector2) == 2 * sizeof(VECTOR_TYPE), "Vector2 should be x and y only");
+static_assert(std::is_trivially_copyable<Vector2>::value, "Vector2 should be trivially copyable");
 
 };  // namespace my_math
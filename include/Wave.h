@@ -12,19 +12,34 @@
 namespace my_math
 {
 
+// Knots of half of front line traced in the last frame. Tracing of the next frame is corrected from them.
+struct FrontPath
+{
+  std::vector<Vector2> positions;
+
+  // Unit tangents of front line in positions.
+  std::vector<Vector2> directions;
+
+  void Clear(void)
+  {
+    positions.clear( );
+    directions.clear( );
+  }
+};
+
 class Wave {
  public:
   Wave();
 
   Wave(const Wave &that);
 
-  Wave(Wave &&that);  
+  Wave(Wave &&that) noexcept;
 
-  void Swap(Wave & that);
+  void Swap(Wave & that) noexcept;
 
   Wave& operator=(const Wave & that);
 
-  Wave& operator=(Wave && that);
+  Wave& operator=(Wave && that) noexcept;
 
   bool Draw(sf::RenderWindow & window);
 
@@ -32,8 +47,12 @@ class Wave {
 
   bool Push(const FrontElement & front_element);
 
+  bool Push(FrontElement && front_element);
+
   FrontElement & GetMain();
 
+  const FrontElement & GetMain() const;
+
   bool Clear();
 
   void SetDrawnSides(const DRAWN_SIDES drawn_sides);
@@ -44,20 +63,39 @@ class Wave {
 
   const WAVE_STATUSES GetWaveStatus(void) const;
 
-  void SetDiffractionGrating(DiffractionGrating *diffraction_grating);
+  /**
+      \breif Set grating of secondary wave. Handle stays valid when gratings are added.
+      \param[in] grating_handle - Handle of grating in Store.
+  */
+  void SetGratingHandle(const SlotHandle & grating_handle);
+
+  SlotHandle GetGratingHandle(void) const;
 
-  DiffractionGrating* GetDiffractionGrating(void) const;
+  void SetSecondarySourceHandle(const SlotHandle & secondary_source_handle);
 
-  void SetSecondarySourceNumber(const int source_number);
+  SlotHandle GetSecondarySourceHandle(void) const;
+
+  /**
+      \breif Give front path of half of wave traced in the last frame.
+      \param[in] is_top_part - True - top half of wave.
+      \return Front path. It is empty, if the half wasn't traced.
+  */
+  const FrontPath & GetFrontPath(const bool is_top_part) const;
 
-  int GetSecondarySourceNumber(void) const;  
+  /**
+      \breif Replace front path of half of wave. Memory of old path is given back to reuse it.
+      \param[in] is_top_part - True - top half of wave.
+      \param[in, out] front_path - New front path. It gets old path.
+  */
+  void SwapFrontPath(const bool is_top_part, FrontPath & front_path);
 
   /**
       \breif This function will delete wave, if it is far from appropriate diffraction grating.
              This creates an interference effect.
+      \param[in] diffraction_grating - Grating of wave.
       \return True - It should be deleted. False - It shouldn't be deleted. 
   */
-  bool IsInterfere(void);  
+  bool IsInterfere(const DiffractionGrating & diffraction_grating) const;
 
   virtual ~Wave();
 
@@ -65,10 +103,13 @@ class Wave {
   std::vector<FrontElement> front_elements_;
   DRAWN_SIDES drawn_sides_;
   WAVE_STATUSES wave_status_;
-  DiffractionGrating *diffraction_grating_;
+  SlotHandle grating_handle_;
+
+  // Secondary source of wave in its grating.
+  SlotHandle secondary_source_handle_;
 
-  // NUmber of dipole in diffraction_grating;
-  int secondary_source_number_;
+  // Top and bottom halves of front line of the last frame.
+  FrontPath front_paths_[2];
 
 };
 
@@ -1,5 +1,7 @@
 
 #include "DiffractionGrating.h"
+#include "DipolePack.h"
+#include "FastTrig.h"
 
 namespace my_math
 {
@@ -15,6 +17,179 @@ namespace my_math
 sf::Texture grating_texture;
 
 
+namespace
+{
+
+// Field of one secondary source: factor * (1 + cos(alpha)) * cos(WAVE_NUMBER * r) / r along rotated by 90 radius
+// vector. Look at SecondarySource::GetFieldStrength( ).
+void SecondaryFieldKernelScalar(const float *x, const float *y, const float *factors, const size_t sources_number,
+                                const float point_x, const float point_y, float *field_x, float *field_y)
+{
+  float sum_x = 0.;
+  float sum_y = 0.;
+
+  for (size_t ind = 0; ind < sources_number; ind++)
+  {
+    const float radius_x = point_x - x[ind];
+    const float radius_y = point_y - y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    const float inverse_distance = 1. / sqrt(square_distance);
+    const float distance = square_distance * inverse_distance;
+
+    // Rotated radius vector is divided by distance twice: once to norm it and once as in field strength.
+    const float field_strength = factors[ind] * (1 + radius_x * inverse_distance) * FastCos(WAVE_NUMBER * distance) *
+                                 inverse_distance * inverse_distance;
+
+    sum_x -= radius_y * field_strength;
+    sum_y += radius_x * field_strength;
+  }
+
+  *field_x = sum_x;
+  *field_y = sum_y;
+  return;
+}
+
+
+// Field of source is g * rotated_radius, where g = factor * (1 + radius_x / r) * cos(WAVE_NUMBER * r) / r^2. So
+// grad(g) = factor * cos(WAVE_NUMBER * r) / r^3 * x_axis - factor / r^2 * (cos(WAVE_NUMBER * r) * radius_x / r^3 +
+//           (1 + radius_x / r) * (WAVE_NUMBER * sin(WAVE_NUMBER * r) / r + 2 * cos(WAVE_NUMBER * r) / r^2)) * radius.
+// Sources are few, so there is no SIMD version.
+void SecondaryFieldJacobianKernel(const float *x, const float *y, const float *factors, const size_t sources_number,
+                                  const float point_x, const float point_y, Vector2 *field_strength,
+                                  FieldJacobian *jacobian)
+{
+  float field_x = 0.;
+  float field_y = 0.;
+  float x_derivative_x = 0.;
+  float y_derivative_x = 0.;
+  float x_derivative_y = 0.;
+  float y_derivative_y = 0.;
+
+  for (size_t ind = 0; ind < sources_number; ind++)
+  {
+    const float radius_x = point_x - x[ind];
+    const float radius_y = point_y - y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    const float inverse_distance = 1. / sqrt(square_distance);
+    const float inverse_square = inverse_distance * inverse_distance;
+    const float angular_part = 1 + radius_x * inverse_distance;
+
+    float wave_sin = 0.;
+    float wave_cos = 0.;
+    FastSinCos(WAVE_NUMBER * square_distance * inverse_distance, &wave_sin, &wave_cos);
+
+    const float strength = factors[ind] * angular_part * wave_cos * inverse_square;
+    const float axis_part = factors[ind] * wave_cos * inverse_square * inverse_distance;
+    const float wave_part = WAVE_NUMBER * wave_sin * inverse_distance + 2 * wave_cos * inverse_square;
+    const float radius_part = -factors[ind] * inverse_square *
+                              (wave_cos * radius_x * inverse_square * inverse_distance + angular_part * wave_part);
+    const float gradient_x = axis_part + radius_part * radius_x;
+    const float gradient_y = radius_part * radius_y;
+
+    field_x -= radius_y * strength;
+    field_y += radius_x * strength;
+    x_derivative_x -= radius_y * gradient_x;
+    y_derivative_x -= strength + radius_y * gradient_y;
+    x_derivative_y += strength + radius_x * gradient_x;
+    y_derivative_y += radius_x * gradient_y;
+  }
+
+  *field_strength = Vector2(field_x, field_y);
+  jacobian -> x_derivative = Vector2(x_derivative_x, x_derivative_y);
+  jacobian -> y_derivative = Vector2(y_derivative_x, y_derivative_y);
+  return;
+}
+
+
+#ifdef FAST_TRIG_X86
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) void SecondaryFieldKernelAvx2(const float *x, const float *y,
+                                                                  const float *factors, const size_t sources_number,
+                                                                  const float point_x, const float point_y,
+                                                                  float *field_x, float *field_y)
+{
+  const __m256 point_x_lanes = _mm256_set1_ps(point_x);
+  const __m256 point_y_lanes = _mm256_set1_ps(point_y);
+  const __m256 one = _mm256_set1_ps(1.);
+
+  __m256 sum_x = _mm256_setzero_ps( );
+  __m256 sum_y = _mm256_setzero_ps( );
+
+  // Full blocks of 8 sources. The rest is summed by scalar kernel.
+  const size_t blocks_end = sources_number - sources_number % 8;
+  for (size_t ind = 0; ind < blocks_end; ind += 8)
+  {
+    const __m256 radius_x = _mm256_sub_ps(point_x_lanes, _mm256_loadu_ps(x + ind));
+    const __m256 radius_y = _mm256_sub_ps(point_y_lanes, _mm256_loadu_ps(y + ind));
+    const __m256 square_distance = _mm256_fmadd_ps(radius_x, radius_x, _mm256_mul_ps(radius_y, radius_y));
+    const __m256 distance = _mm256_sqrt_ps(square_distance);
+    const __m256 inverse_distance = _mm256_div_ps(one, distance);
+
+    const __m256 wave_part = CosAvx2<accuracy>(_mm256_mul_ps(_mm256_set1_ps(WAVE_NUMBER), distance));
+    const __m256 angular_part = _mm256_fmadd_ps(radius_x, inverse_distance, one);
+
+    __m256 field_strength = _mm256_mul_ps(_mm256_loadu_ps(factors + ind), angular_part);
+    field_strength = _mm256_mul_ps(_mm256_mul_ps(field_strength, wave_part), inverse_distance);
+    field_strength = _mm256_mul_ps(field_strength, inverse_distance);
+
+    // Sources in the point give nothing.
+    const __m256 mask = _mm256_cmp_ps(square_distance, _mm256_setzero_ps( ), _CMP_NEQ_UQ);
+    sum_x = _mm256_sub_ps(sum_x, _mm256_and_ps(mask, _mm256_mul_ps(radius_y, field_strength)));
+    sum_y = _mm256_add_ps(sum_y, _mm256_and_ps(mask, _mm256_mul_ps(radius_x, field_strength)));
+  }
+
+  float lanes_x[8];
+  float lanes_y[8];
+  _mm256_storeu_ps(lanes_x, sum_x);
+  _mm256_storeu_ps(lanes_y, sum_y);
+
+  float rest_x = 0.;
+  float rest_y = 0.;
+  SecondaryFieldKernelScalar(x + blocks_end, y + blocks_end, factors + blocks_end, sources_number - blocks_end,
+                             point_x, point_y, &rest_x, &rest_y);
+
+  *field_x = ((lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3])) +
+             ((lanes_x[4] + lanes_x[5]) + (lanes_x[6] + lanes_x[7])) + rest_x;
+  *field_y = ((lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3])) +
+             ((lanes_y[4] + lanes_y[5]) + (lanes_y[6] + lanes_y[7])) + rest_y;
+  return;
+}
+
+#endif /* FAST_TRIG_X86 */
+
+} // End of anonymous namespace.
+
+
+SecondaryFieldKernel GetSecondaryFieldKernel(void)
+{
+  // Kernels are chosen at the first call: DipolePack chooses set of instructions at start of the program.
+  // REFERENCE_TRIG uses cos of libm, so it hasn't SIMD kernel.
+  #ifdef FAST_TRIG_X86
+  static const bool is_avx2 = DipolePack::GetSimdLevel( ) == AVX2_LEVEL;
+  static const SecondaryFieldKernel kernels[TRIG_ACCURACIES_NUMBER] =
+      {is_avx2 ? SecondaryFieldKernelAvx2<FAST_TRIG> : SecondaryFieldKernelScalar,
+       is_avx2 ? SecondaryFieldKernelAvx2<APPROXIMATE_TRIG> : SecondaryFieldKernelScalar,
+       SecondaryFieldKernelScalar};
+  return kernels[GetTrigAccuracy( )];
+  #else
+  return SecondaryFieldKernelScalar;
+  #endif /* FAST_TRIG_X86 */
+}
+
+
 
 sf::Sprite DiffractionGrating::CreateHatchSprite(const Vector2 & position) 
 {
@@ -70,10 +245,10 @@ void DiffractionGrating::CreateProportions(const int hatch_ind)
 
 DiffractionGrating::DiffractionGrating(const Vector2 & position, const float period, const float slot_width, const int num_hatches)
     :  Element(position),
+       is_first_wave_created_(false),
        period_(period),
        slot_width_(slot_width),
-       num_hatches_(num_hatches),
-       is_first_wave_created_(false)
+       num_hatches_(num_hatches)
 {
   #ifndef GRATING_TEXTURE_WAS_CREATED
   CreateGratingTexture(grating_texture);
@@ -120,10 +295,15 @@ DiffractionGrating::DiffractionGrating(const Vector2 & position, const float per
     CreateProportions(num_hatches_ - 1); 
   }
 
-  for (int ind = 0; ind < num_hatches_ - 1; ind ++)
+  // Slots are between hatches from bottom to top.
+  const float bottom_slot_y = position_.GetY( ) + (num_hatches_ - 2) * period_ / 2;
+  for (int ind = 0; ind < num_hatches_ - 1; ind++)
   {
-    secondary_sources_presence_.push_back(false);
+    slot_centers_.push_back(bottom_slot_y - ind * period_);
   }
+
+  active_indices_.assign(num_hatches_ - 1, -1);
+  source_generations_.assign(num_hatches_ - 1, 0);
   secondary_sources_.resize(num_hatches_ - 1);
 
   return;
@@ -131,13 +311,19 @@ DiffractionGrating::DiffractionGrating(const Vector2 & position, const float per
 
 DiffractionGrating::DiffractionGrating(const DiffractionGrating & that)
     :  Element(that),
+       is_first_wave_created_(that.is_first_wave_created_),
        period_(that.period_),
        slot_width_(that.slot_width_),
        num_hatches_(that.num_hatches_),
        hatches_(that.hatches_),
-       secondary_sources_presence_(that.secondary_sources_presence_),
+       slot_centers_(that.slot_centers_),
        secondary_sources_(that.secondary_sources_),
-       is_first_wave_created_(that.is_first_wave_created_)  {
+       active_indices_(that.active_indices_),
+       source_generations_(that.source_generations_),
+       active_slots_(that.active_slots_),
+       active_x_(that.active_x_),
+       active_y_(that.active_y_),
+       active_factors_(that.active_factors_)  {
 
     for (int ind = 0; ind < 4; ind++)
     {
@@ -147,15 +333,21 @@ DiffractionGrating::DiffractionGrating(const DiffractionGrating & that)
 }
 
 
-DiffractionGrating::DiffractionGrating(DiffractionGrating && that)
-    :  Element(that),
+DiffractionGrating::DiffractionGrating(DiffractionGrating && that) noexcept
+    :  Element(std::move(that)),
+       is_first_wave_created_(std::move(that.is_first_wave_created_)),
        period_(std::move(that.period_)),
        slot_width_(std::move(that.slot_width_)),
        num_hatches_(std::move(that.num_hatches_)),
        hatches_(std::move(that.hatches_)),
+       slot_centers_(std::move(that.slot_centers_)),
        secondary_sources_(std::move(that.secondary_sources_)),
-       secondary_sources_presence_(std::move(that.secondary_sources_presence_)),
-       is_first_wave_created_(std::move(that.is_first_wave_created_))  {
+       active_indices_(std::move(that.active_indices_)),
+       source_generations_(std::move(that.source_generations_)),
+       active_slots_(std::move(that.active_slots_)),
+       active_x_(std::move(that.active_x_)),
+       active_y_(std::move(that.active_y_)),
+       active_factors_(std::move(that.active_factors_))  {
 
     for (int ind = 0; ind < 4; ind++)
     {
@@ -189,9 +381,9 @@ bool DiffractionGrating::Dump(void) const
   std::cout << "\tis_first_wave_created:  " << is_first_wave_created_ << std::endl;
 
   std::cout << "Secondary sources presence:\n" << std::endl;
-  for (int ind = 0; ind < secondary_sources_presence_.size( ); ind++)
+  for (size_t ind = 0; ind < active_indices_.size( ); ind++)
   {
-    std::cout << secondary_sources_presence_[ind];
+    std::cout << (active_indices_[ind] >= 0);
   }
   std::cout << std::endl;
 
@@ -245,20 +437,27 @@ int DiffractionGrating::GetNumberHatches(void) const
 }
 
 bool DiffractionGrating::CreateSecondarySourceCollision(const Vector2 & position, const int ind,
-                         Vector2 *secondary_source_coordinate, int *secondary_source_number, bool* is_main_wave)
+                         Vector2 *secondary_source_coordinate, SlotHandle *secondary_source, bool* is_main_wave)
 {
   assert(secondary_source_coordinate != nullptr);
 
-  if (secondary_sources_presence_[ind] == true)
+  if (active_indices_[ind] >= 0)
   {
     return false;
   }
   else
   {
-    secondary_sources_presence_[ind] = true;
     secondary_sources_[ind] = SecondarySource(position, slot_width_);
+
+    // Base field strength isn't known yet, so source gives nothing until UpdateBaseFieldStrengths( ).
+    active_indices_[ind] = active_slots_.size( );
+    active_slots_.push_back(ind);
+    active_x_.push_back(position.GetX( ));
+    active_y_.push_back(position.GetY( ));
+    active_factors_.push_back(0.);
+
     *secondary_source_coordinate = position;
-    *secondary_source_number = ind;
+    *secondary_source = SlotHandle{static_cast<uint32_t>(ind), source_generations_[ind]};
 
     if (!is_first_wave_created_)
     {
@@ -276,116 +475,164 @@ bool DiffractionGrating::CreateSecondarySourceCollision(const Vector2 & position
 }
 
 bool DiffractionGrating::HandleCollision(const Vector2 & position, Vector2 *secondary_source_coordinate,
-                                         int *secondary_source_number, bool* is_main_wave)
+                                         SlotHandle *secondary_source, bool* is_main_wave)
 {
-  assert(secondary_source_number != nullptr);
+  assert(secondary_source != nullptr);
   assert(is_main_wave != nullptr);
 
-  Vector2 basis_vector = Vector2(0., 1.);
+  if (slot_centers_.empty( ))
+  {
+    return false;
+  }
 
+  // Slots are every period_ from the bottom one, so the nearest slot is got directly. Slots are narrower than
+  // period_, so no other slot can contain position.
+  const float y_position = position.GetY( );
+  const float slot_ind = std::round((slot_centers_[0] - y_position) / period_);
+  if (!(slot_ind >= 0 && slot_ind < slot_centers_.size( )))
+  {
+    return false;
+  }
 
-  float y_position = position.GetY( );
-  if (num_hatches_ % 2 == 0)
+  const int ind = static_cast<int>(slot_ind);
+  if (fabs(y_position - slot_centers_[ind]) > slot_width_ / 2)
   {
-    // Jump to the bottom.
-    int num_bottom_jumps = (num_hatches_ - 2) / 2;
-    Vector2 position_now = position_ + num_bottom_jumps * period_ * basis_vector;
+    // There was only a black part of diffraction_grating.
+    return false;
+  }
 
-    if (y_position <= position_now.GetY( ) + slot_width_ / 2 && y_position >= position_now.GetY( ) - slot_width_ / 2)
-    {
-      bool status = CreateSecondarySourceCollision(position_now, 0, secondary_source_coordinate, secondary_source_number, 
-                                                   is_main_wave);
-      
-      CHECK
-      return status;
-    }
+  bool status = CreateSecondarySourceCollision(Vector2(position_.GetX( ), slot_centers_[ind]), ind,
+                                               secondary_source_coordinate, secondary_source, is_main_wave);
 
-    for (int ind = 1; ind <= num_hatches_ - 2; ind++)
-    {
-      position_now -= period_ * basis_vector;
-      if (y_position <= position_now.GetY( ) + slot_width_ / 2 && y_position >= position_now.GetY( ) - slot_width_ / 2)
-      {
-        bool status = CreateSecondarySourceCollision(position_now, ind, secondary_source_coordinate, secondary_source_number,
-                                                     is_main_wave);
-
-        CHECK
-        return status;
-      }
-    }
+  CHECK
+  return status;
+}
+
+void DiffractionGrating::RemoveSecondarySource(const SlotHandle & secondary_source, const WAVE_STATUSES wave_status)
+{
+  if (wave_status == SECONDARY_MAIN_WAVE)
+  {
+    is_first_wave_created_ = false;
   }
-  else
+
+  if (secondary_source.index >= source_generations_.size( ) ||
+      source_generations_[secondary_source.index] != secondary_source.generation)
   {
-    if (num_hatches_ == 1)
-    {
-      return false;
-    }
+    return;
+  }
 
-    Vector2 position_now = position_ +  basis_vector * period_ / 2;
+  RemoveSlot(secondary_source.index);
+  return;
+}
 
-    int num_bottom_jumps = (num_hatches_ - 3) / 2;
-    position_now += num_bottom_jumps * period_ * basis_vector;
-    if (y_position <= position_now.GetY( ) + slot_width_ / 2 && y_position >= position_now.GetY( ) - slot_width_ / 2)
-    {
-      bool status = CreateSecondarySourceCollision(position_now, 0, secondary_source_coordinate, secondary_source_number,
-                                                   is_main_wave);
+void DiffractionGrating::RemoveSecondarySources(void)
+{
+  is_first_wave_created_ = false;
+  for (int ind = 0; ind < static_cast<int>(active_indices_.size( )); ind++)
+  {
+    RemoveSlot(ind);
+  }
 
-      CHECK
-      return status;
-    }     
+  return;
+}
 
-    for (int ind = 1; ind <= num_hatches_ - 2; ind++)
-    {
-      position_now -= period_ * basis_vector;
+void DiffractionGrating::RemoveSlot(const int ind)
+{
+  const int active_ind = active_indices_[ind];
+  if (active_ind < 0)
+  {
+    return;
+  }
 
-      if (y_position <= position_now.GetY( ) + slot_width_ / 2 && y_position >= position_now.GetY( ) - slot_width_ / 2)
-      {
-        bool status = CreateSecondarySourceCollision(position_now, ind, secondary_source_coordinate, secondary_source_number,
-                                                     is_main_wave);
+  // The last active source takes place of removed one.
+  const int last_ind = active_slots_.size( ) - 1;
+  active_slots_[active_ind] = active_slots_[last_ind];
+  active_x_[active_ind] = active_x_[last_ind];
+  active_y_[active_ind] = active_y_[last_ind];
+  active_factors_[active_ind] = active_factors_[last_ind];
+  active_indices_[active_slots_[active_ind]] = active_ind;
 
-        CHECK
-        return status;
-      }     
-    }
+  active_slots_.pop_back( );
+  active_x_.pop_back( );
+  active_y_.pop_back( );
+  active_factors_.pop_back( );
+  active_indices_[ind] = -1;
+  source_generations_[ind]++;
 
-  }
 
-  // There was only a black part of diffraction_grating.
-  return false;
+  return;
 }
 
-void DiffractionGrating::RemoveSecondarySource(const int ind, const WAVE_STATUSES wave_status)
+void DiffractionGrating::UpdateBaseFieldStrengths(const DipolePack &dipoles, const float t)
 {
-  if (wave_status == SECONDARY_MAIN_WAVE)
+  const size_t active_number = active_slots_.size( );
+  if (active_number == 0)
   {
-    is_first_wave_created_ = false;
+    return;
   }
-  secondary_sources_presence_[ind] = false;
 
+  std::vector<Vector2> positions(active_number);
+  for (size_t ind = 0; ind < active_number; ind++)
+  {
+    positions[ind] = Vector2(active_x_[ind], active_y_[ind]);
+  }
+
+  // Field of dipoles in all secondary sources is got by one batch.
+  std::vector<Vector2> base_field_strengths(active_number);
+  dipoles.GetFieldStrength(positions.data( ), base_field_strengths.data( ), active_number, t);
+
+  for (size_t ind = 0; ind < active_number; ind++)
+  {
+    SecondarySource & secondary_source = secondary_sources_[active_slots_[ind]];
+    secondary_source.SetBaseFieldStrength(base_field_strengths[ind]);
+    active_factors_[ind] = secondary_source.GetRadiationFactor( );
+  }
 
   return;
 }
 
-Vector2 DiffractionGrating::GetFieldStrength(const Vector2 & position, const float t,
-                                             const std::vector<Dipole> &dipoles_) const
+Vector2 DiffractionGrating::GetFieldStrength(const Vector2 & position, const float /* t */) const
 {
-  Vector2 result = Vector2(0., 0.);
-  Vector2 additional_strength;
+  float field_x = 0.;
+  float field_y = 0.;
+  GetSecondaryFieldKernel( )(active_x_.data( ), active_y_.data( ), active_factors_.data( ), active_slots_.size( ),
+                             position.GetX( ), position.GetY( ), &field_x, &field_y);
 
-  for (int ind = 0; ind < secondary_sources_presence_.size( ); ind++)
-  {
-    if (secondary_sources_presence_[ind])
-    {
-      additional_strength = secondary_sources_[ind].GetFieldStrength(position, t, dipoles_);
-      result += additional_strength;
+  #ifdef SECONDARY_SOURCE_STRENGTH_DEBAG
+  std::cout << "field from " << active_slots_.size( ) << " secondary sources = " << Vector2(field_x, field_y) <<
+               "\n\n";
+  #endif
 
-      #ifdef SECONDARY_SOURCE_STRENGTH_DEBAG
-      std::cout << "field from secondary source number " << ind << " = " << additional_strength << "\n\n";
-      #endif    
+  return Vector2(field_x, field_y);
+}
 
-    }
+Vector2 DiffractionGrating::GetFieldStrength(const Vector2 & position, const float /* t */, FieldJacobian *jacobian) const
+{
+  assert(jacobian != nullptr);
+
+  Vector2 field_strength;
+  SecondaryFieldJacobianKernel(active_x_.data( ), active_y_.data( ), active_factors_.data( ), active_slots_.size( ),
+                               position.GetX( ), position.GetY( ), &field_strength, jacobian);
+  return field_strength;
+}
+
+void DiffractionGrating::GetFieldStrength(const Vector2 *positions, Vector2 *field_strengths,
+                                          const size_t points_number, const float /* t */) const
+{
+  assert(positions != nullptr);
+  assert(field_strengths != nullptr);
+
+  const SecondaryFieldKernel kernel = GetSecondaryFieldKernel( );
+  for (size_t ind = 0; ind < points_number; ind++)
+  {
+    float field_x = 0.;
+    float field_y = 0.;
+    kernel(active_x_.data( ), active_y_.data( ), active_factors_.data( ), active_slots_.size( ),
+           positions[ind].GetX( ), positions[ind].GetY( ), &field_x, &field_y);
+    field_strengths[ind] = Vector2(field_x, field_y);
   }
 
-  return result;
+  return;
 }
 
 } // End of namespace my_math.
@@ -0,0 +1,1165 @@
+#include "DipolePack.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "FastTrig.h"
+
+namespace my_math
+{
+
+namespace
+{
+
+// Pointers on arrays of DipolePack. Kernels get it instead of the pack.
+struct PackView
+{
+  const float *x;
+  const float *y;
+  const float *direction_x;
+  const float *direction_y;
+  const float *phase;
+  const float *amplitude;
+};
+
+typedef void (*FieldKernel)(const PackView & pack, const size_t first, const size_t last, const float point_x,
+                            const float point_y, const float time_phase, float *field_x, float *field_y);
+
+// Field strength and its derivatives: field_x, field_y, dfield_x / dx, dfield_x / dy, dfield_y / dx, dfield_y / dy.
+const size_t FIELD_JACOBIAN_SIZE = 6;
+
+typedef void (*FieldJacobianKernel)(const PackView & pack, const size_t first, const size_t last,
+                                    const float point_x, const float point_y, const float time_phase, float *sums);
+
+// Anchors of PathPhasors. Kernels get it instead of the path.
+struct PathView
+{
+  float *anchor_distance;
+  float *anchor_sin;
+  float *anchor_cos;
+};
+
+typedef void (*PathFieldKernel)(const PackView & pack, const PathView & path, const size_t first, const size_t last,
+                                const float point_x, const float point_y, const float time_phase, float *field_x,
+                                float *field_y);
+
+typedef void (*PathFieldJacobianKernel)(const PackView & pack, const PathView & path, const size_t first,
+                                        const size_t last, const float point_x, const float point_y,
+                                        const float time_phase, float *sums);
+
+typedef void (*FrontKernel)(const PackView & pack, const size_t first, const size_t last, const float point_x,
+                            const float point_y, float *in_phase_part, float *quadrature_part);
+
+// Anchor distance of new path. Angle of rotation from it is greater than PATH_PHASOR_MAX_ROTATION in any point.
+const float PATH_UNANCHORED_DISTANCE = std::numeric_limits<float>::max( );
+
+
+void FieldKernelScalar(const PackView & pack, const size_t first, const size_t last, const float point_x,
+                       const float point_y, const float time_phase, float *field_x, float *field_y)
+{
+  float sum_x = 0.;
+  float sum_y = 0.;
+
+  for (size_t ind = first; ind < last; ind++)
+  {
+    const float radius_x = point_x - pack.x[ind];
+    const float radius_y = point_y - pack.y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    const float inverse_distance = 1. / sqrt(square_distance);
+    const float distance = square_distance * inverse_distance;
+    const float angular_coefficient = fabs(radius_x * pack.direction_x[ind] + radius_y * pack.direction_y[ind]) *
+                                      inverse_distance;
+    const float harmonic_part = FastSin(time_phase - DISTANCE_PHASE_FACTOR * distance + pack.phase[ind]);
+
+    // Rotated by 90 radius vector divided by distance twice: once to norm it and once as in field strength.
+    const float field_strength = pack.amplitude[ind] * angular_coefficient * harmonic_part * DISTANT_SCALE *
+                                 inverse_distance * inverse_distance;
+
+    sum_x -= radius_y * field_strength;
+    sum_y += radius_x * field_strength;
+  }
+
+  *field_x = sum_x;
+  *field_y = sum_y;
+  return;
+}
+
+
+// Field of dipole is g * rotated_radius, where g = amplitude * DISTANT_SCALE * |radius * direction| * sin(phase) /
+// distance^3 and phase = time_phase - DISTANCE_PHASE_FACTOR * distance + dipole_phase. So
+// grad(g) = amplitude * DISTANT_SCALE / distance^3 * (sign * sin(phase) * direction -
+//           |radius * direction| * (DISTANCE_PHASE_FACTOR * cos(phase) / distance + 3 * sin(phase) / distance^2) * radius).
+inline void AddFieldJacobian(const PackView & pack, const size_t ind, const float radius_x, const float radius_y,
+                             const float inverse_distance, const float harmonic_sin, const float harmonic_cos,
+                             float *sums)
+{
+  const float projection = radius_x * pack.direction_x[ind] + radius_y * pack.direction_y[ind];
+  const float angular = fabs(projection);
+
+  const float scale = pack.amplitude[ind] * DISTANT_SCALE * inverse_distance * inverse_distance * inverse_distance;
+  const float strength = scale * angular * harmonic_sin;
+  const float direction_part = projection > 0 ? scale * harmonic_sin : -scale * harmonic_sin;
+  const float radius_part = -scale * angular * inverse_distance * (DISTANCE_PHASE_FACTOR * harmonic_cos +
+                                                                   3 * harmonic_sin * inverse_distance);
+  const float gradient_x = direction_part * pack.direction_x[ind] + radius_part * radius_x;
+  const float gradient_y = direction_part * pack.direction_y[ind] + radius_part * radius_y;
+
+  sums[0] -= radius_y * strength;
+  sums[1] += radius_x * strength;
+  sums[2] -= radius_y * gradient_x;
+  sums[3] -= strength + radius_y * gradient_y;
+  sums[4] += strength + radius_x * gradient_x;
+  sums[5] += radius_x * gradient_y;
+  return;
+}
+
+
+void FieldJacobianKernelScalar(const PackView & pack, const size_t first, const size_t last, const float point_x,
+                               const float point_y, const float time_phase, float *sums)
+{
+  for (size_t part = 0; part < FIELD_JACOBIAN_SIZE; part++)
+  {
+    sums[part] = 0.;
+  }
+
+  for (size_t ind = first; ind < last; ind++)
+  {
+    const float radius_x = point_x - pack.x[ind];
+    const float radius_y = point_y - pack.y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    const float inverse_distance = 1. / sqrt(square_distance);
+
+    float harmonic_sin = 0.;
+    float harmonic_cos = 0.;
+    FastSinCos(time_phase - DISTANCE_PHASE_FACTOR * square_distance * inverse_distance + pack.phase[ind],
+               &harmonic_sin, &harmonic_cos);
+
+    AddFieldJacobian(pack, ind, radius_x, radius_y, inverse_distance, harmonic_sin, harmonic_cos, sums);
+  }
+
+  return;
+}
+
+
+// Phase of dipole in point is its phase in anchor plus rotation = DISTANCE_PHASE_FACTOR * (anchor_distance - distance).
+// Anchor is moved to the point, if rotation is too large for series of sin and cos.
+inline void GetPathHarmonic(const PackView & pack, const PathView & path, const size_t ind, const float distance,
+                            const float time_phase, float *harmonic_sin, float *harmonic_cos)
+{
+  float rotation = DISTANCE_PHASE_FACTOR * (path.anchor_distance[ind] - distance);
+  if (fabs(rotation) > PATH_PHASOR_MAX_ROTATION)
+  {
+    FastSinCos(time_phase - DISTANCE_PHASE_FACTOR * distance + pack.phase[ind], &path.anchor_sin[ind],
+               &path.anchor_cos[ind]);
+    path.anchor_distance[ind] = distance;
+    rotation = 0.;
+  }
+
+  const float square_rotation = rotation * rotation;
+  const float rotation_sin = rotation * (1 - square_rotation * (1. / 6));
+  const float rotation_cos = 1 - square_rotation * (0.5 - square_rotation * (1. / 24));
+
+  *harmonic_sin = path.anchor_sin[ind] * rotation_cos + path.anchor_cos[ind] * rotation_sin;
+  *harmonic_cos = path.anchor_cos[ind] * rotation_cos - path.anchor_sin[ind] * rotation_sin;
+  return;
+}
+
+
+void PathFieldKernelScalar(const PackView & pack, const PathView & path, const size_t first, const size_t last,
+                           const float point_x, const float point_y, const float time_phase, float *field_x,
+                           float *field_y)
+{
+  float sum_x = 0.;
+  float sum_y = 0.;
+
+  for (size_t ind = first; ind < last; ind++)
+  {
+    const float radius_x = point_x - pack.x[ind];
+    const float radius_y = point_y - pack.y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    const float inverse_distance = 1. / sqrt(square_distance);
+    const float angular_coefficient = fabs(radius_x * pack.direction_x[ind] + radius_y * pack.direction_y[ind]) *
+                                      inverse_distance;
+
+    float harmonic_sin = 0.;
+    float harmonic_cos = 0.;
+    GetPathHarmonic(pack, path, ind, square_distance * inverse_distance, time_phase, &harmonic_sin, &harmonic_cos);
+
+    const float field_strength = pack.amplitude[ind] * angular_coefficient * harmonic_sin * DISTANT_SCALE *
+                                 inverse_distance * inverse_distance;
+
+    sum_x -= radius_y * field_strength;
+    sum_y += radius_x * field_strength;
+  }
+
+  *field_x = sum_x;
+  *field_y = sum_y;
+  return;
+}
+
+
+void PathFieldJacobianKernelScalar(const PackView & pack, const PathView & path, const size_t first,
+                                   const size_t last, const float point_x, const float point_y,
+                                   const float time_phase, float *sums)
+{
+  for (size_t part = 0; part < FIELD_JACOBIAN_SIZE; part++)
+  {
+    sums[part] = 0.;
+  }
+
+  for (size_t ind = first; ind < last; ind++)
+  {
+    const float radius_x = point_x - pack.x[ind];
+    const float radius_y = point_y - pack.y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    const float inverse_distance = 1. / sqrt(square_distance);
+
+    float harmonic_sin = 0.;
+    float harmonic_cos = 0.;
+    GetPathHarmonic(pack, path, ind, square_distance * inverse_distance, time_phase, &harmonic_sin, &harmonic_cos);
+
+    AddFieldJacobian(pack, ind, radius_x, radius_y, inverse_distance, harmonic_sin, harmonic_cos, sums);
+  }
+
+  return;
+}
+
+
+void FrontKernelScalar(const PackView & pack, const size_t first, const size_t last, const float point_x,
+                       const float point_y, float *in_phase_part, float *quadrature_part)
+{
+  float in_phase_sum = 0.;
+  float quadrature_sum = 0.;
+
+  for (size_t ind = first; ind < last; ind++)
+  {
+    const float radius_x = point_x - pack.x[ind];
+    const float radius_y = point_y - pack.y[ind];
+    const float square_distance = radius_x * radius_x + radius_y * radius_y;
+
+    if (square_distance == 0.)
+    {
+      continue;
+    }
+
+    // ln(distance) = ln(square_distance) / 2.
+    const float scale = pack.amplitude[ind] * DISTANT_SCALE * 0.5 * log(square_distance);
+    float harmonic_sin = 0.;
+    float harmonic_cos = 0.;
+    FastSinCos(pack.phase[ind] - DISTANCE_PHASE_FACTOR * sqrt(square_distance), &harmonic_sin, &harmonic_cos);
+
+    // sin(time_phase + x) = sin(x) * cos(time_phase) + cos(x) * sin(time_phase).
+    in_phase_sum += scale * harmonic_sin;
+    quadrature_sum += scale * harmonic_cos;
+  }
+
+  *in_phase_part = in_phase_sum;
+  *quadrature_part = quadrature_sum;
+  return;
+}
+
+
+#ifdef FAST_TRIG_X86
+
+template <TRIG_ACCURACIES accuracy>
+void FieldKernelSse2(const PackView & pack, const size_t first, const size_t last, const float point_x,
+                     const float point_y, const float time_phase, float *field_x, float *field_y)
+{
+  const __m128 point_x_lanes = _mm_set1_ps(point_x);
+  const __m128 point_y_lanes = _mm_set1_ps(point_y);
+  const __m128 time_phase_lanes = _mm_set1_ps(time_phase);
+  const __m128 distance_phase_factor = _mm_set1_ps(DISTANCE_PHASE_FACTOR);
+  const __m128 distant_scale = _mm_set1_ps(DISTANT_SCALE);
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128i lane_offsets = _mm_setr_epi32(0, 1, 2, 3);
+  const __m128i last_lanes = _mm_set1_epi32(last);
+
+  __m128 sum_x = _mm_setzero_ps( );
+  __m128 sum_y = _mm_setzero_ps( );
+
+  for (size_t ind = first; ind < last; ind += 4)
+  {
+    const __m128 radius_x = _mm_sub_ps(point_x_lanes, _mm_loadu_ps(pack.x + ind));
+    const __m128 radius_y = _mm_sub_ps(point_y_lanes, _mm_loadu_ps(pack.y + ind));
+    const __m128 square_distance = _mm_add_ps(_mm_mul_ps(radius_x, radius_x), _mm_mul_ps(radius_y, radius_y));
+    const __m128 distance = _mm_sqrt_ps(square_distance);
+    const __m128 inverse_distance = _mm_div_ps(_mm_set1_ps(1.), distance);
+
+    const __m128 projection = _mm_add_ps(_mm_mul_ps(radius_x, _mm_loadu_ps(pack.direction_x + ind)),
+                                         _mm_mul_ps(radius_y, _mm_loadu_ps(pack.direction_y + ind)));
+    const __m128 angular_coefficient = _mm_mul_ps(_mm_and_ps(projection, abs_mask), inverse_distance);
+
+    const __m128 phase = _mm_add_ps(_mm_sub_ps(time_phase_lanes, _mm_mul_ps(distance_phase_factor, distance)),
+                                    _mm_loadu_ps(pack.phase + ind));
+    const __m128 harmonic_part = SinSse2<accuracy>(phase);
+
+    __m128 field_strength = _mm_mul_ps(_mm_loadu_ps(pack.amplitude + ind), angular_coefficient);
+    field_strength = _mm_mul_ps(_mm_mul_ps(field_strength, harmonic_part), distant_scale);
+    field_strength = _mm_mul_ps(_mm_mul_ps(field_strength, inverse_distance), inverse_distance);
+
+    // Lanes after last and dipoles in the point give nothing.
+    const __m128i lanes = _mm_add_epi32(_mm_set1_epi32(ind), lane_offsets);
+    const __m128 mask = _mm_and_ps(_mm_castsi128_ps(_mm_cmplt_epi32(lanes, last_lanes)),
+                                   _mm_cmpneq_ps(square_distance, _mm_setzero_ps( )));
+
+    sum_x = _mm_sub_ps(sum_x, _mm_and_ps(mask, _mm_mul_ps(radius_y, field_strength)));
+    sum_y = _mm_add_ps(sum_y, _mm_and_ps(mask, _mm_mul_ps(radius_x, field_strength)));
+  }
+
+  float lanes_x[4];
+  float lanes_y[4];
+  _mm_storeu_ps(lanes_x, sum_x);
+  _mm_storeu_ps(lanes_y, sum_y);
+  *field_x = (lanes_x[0] + lanes_x[1]) + (lanes_x[2] + lanes_x[3]);
+  *field_y = (lanes_y[0] + lanes_y[1]) + (lanes_y[2] + lanes_y[3]);
+  return;
+}
+
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) inline void FieldBlockAvx2(const PackView & pack, const size_t ind,
+                                                               const size_t last, const __m256 point_x,
+                                                               const __m256 point_y, const __m256 time_phase,
+                                                               __m256 *sum_x, __m256 *sum_y)
+{
+  const __m256 radius_x = _mm256_sub_ps(point_x, _mm256_loadu_ps(pack.x + ind));
+  const __m256 radius_y = _mm256_sub_ps(point_y, _mm256_loadu_ps(pack.y + ind));
+  const __m256 square_distance = _mm256_fmadd_ps(radius_x, radius_x, _mm256_mul_ps(radius_y, radius_y));
+  const __m256 distance = _mm256_sqrt_ps(square_distance);
+  const __m256 inverse_distance = _mm256_div_ps(_mm256_set1_ps(1.), distance);
+
+  const __m256 projection = _mm256_fmadd_ps(radius_x, _mm256_loadu_ps(pack.direction_x + ind),
+                                            _mm256_mul_ps(radius_y, _mm256_loadu_ps(pack.direction_y + ind)));
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 angular_coefficient = _mm256_mul_ps(_mm256_and_ps(projection, abs_mask), inverse_distance);
+
+  const __m256 phase = _mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(DISTANCE_PHASE_FACTOR), distance, time_phase),
+                                     _mm256_loadu_ps(pack.phase + ind));
+  const __m256 harmonic_part = SinAvx2<accuracy>(phase);
+
+  __m256 field_strength = _mm256_mul_ps(_mm256_loadu_ps(pack.amplitude + ind), angular_coefficient);
+  field_strength = _mm256_mul_ps(_mm256_mul_ps(field_strength, harmonic_part), _mm256_set1_ps(DISTANT_SCALE));
+  field_strength = _mm256_mul_ps(_mm256_mul_ps(field_strength, inverse_distance), inverse_distance);
+
+  // Lanes after last and dipoles in the point give nothing.
+  const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(ind), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256 mask = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(last), lanes)),
+                                    _mm256_cmp_ps(square_distance, _mm256_setzero_ps( ), _CMP_NEQ_UQ));
+
+  *sum_x = _mm256_sub_ps(*sum_x, _mm256_and_ps(mask, _mm256_mul_ps(radius_y, field_strength)));
+  *sum_y = _mm256_add_ps(*sum_y, _mm256_and_ps(mask, _mm256_mul_ps(radius_x, field_strength)));
+  return;
+}
+
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) void FieldKernelAvx2(const PackView & pack, const size_t first,
+                                                         const size_t last, const float point_x,
+                                                         const float point_y, const float time_phase,
+                                                         float *field_x, float *field_y)
+{
+  const __m256 point_x_lanes = _mm256_set1_ps(point_x);
+  const __m256 point_y_lanes = _mm256_set1_ps(point_y);
+  const __m256 time_phase_lanes = _mm256_set1_ps(time_phase);
+
+  // Two independent blocks of 8 dipoles per iteration.
+  __m256 sum_x[2] = {_mm256_setzero_ps( ), _mm256_setzero_ps( )};
+  __m256 sum_y[2] = {_mm256_setzero_ps( ), _mm256_setzero_ps( )};
+
+  for (size_t ind = first; ind < last; ind += 16)
+  {
+    FieldBlockAvx2<accuracy>(pack, ind, last, point_x_lanes, point_y_lanes, time_phase_lanes, &sum_x[0], &sum_y[0]);
+    FieldBlockAvx2<accuracy>(pack, ind + 8, last, point_x_lanes, point_y_lanes, time_phase_lanes, &sum_x[1], &sum_y[1]);
+  }
+
+  const __m256 total_x = _mm256_add_ps(sum_x[0], sum_x[1]);
+  const __m256 total_y = _mm256_add_ps(sum_y[0], sum_y[1]);
+  __m128 half_x = _mm_add_ps(_mm256_castps256_ps128(total_x), _mm256_extractf128_ps(total_x, 1));
+  __m128 half_y = _mm_add_ps(_mm256_castps256_ps128(total_y), _mm256_extractf128_ps(total_y, 1));
+  half_x = _mm_hadd_ps(half_x, half_y);
+  half_x = _mm_hadd_ps(half_x, half_x);
+
+  *field_x = _mm_cvtss_f32(half_x);
+  *field_y = _mm_cvtss_f32(_mm_shuffle_ps(half_x, half_x, 1));
+  return;
+}
+
+
+// Look at AddFieldJacobian( ). Lanes out of mask give nothing.
+__attribute__((target("avx2,fma"))) inline void AddFieldJacobianAvx2(const PackView & pack, const size_t ind,
+                                                                     const __m256 mask, const __m256 radius_x,
+                                                                     const __m256 radius_y,
+                                                                     const __m256 lanes_inverse_distance,
+                                                                     const __m256 harmonic_sin,
+                                                                     const __m256 harmonic_cos, __m256 *lanes_sums)
+{
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 sign_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+
+  const __m256 direction_x = _mm256_loadu_ps(pack.direction_x + ind);
+  const __m256 direction_y = _mm256_loadu_ps(pack.direction_y + ind);
+  const __m256 projection = _mm256_fmadd_ps(radius_x, direction_x, _mm256_mul_ps(radius_y, direction_y));
+  const __m256 angular = _mm256_and_ps(projection, abs_mask);
+
+  // Inverse distance of dipole in the point is inf, and inf * 0 would be NaN in every part below. So it is 0 out of
+  // mask, and such lanes give exact zeros.
+  const __m256 inverse_distance = _mm256_and_ps(mask, lanes_inverse_distance);
+  const __m256 inverse_square = _mm256_mul_ps(inverse_distance, inverse_distance);
+  const __m256 scale = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(pack.amplitude + ind),
+                                                   _mm256_set1_ps(DISTANT_SCALE)),
+                                     _mm256_mul_ps(inverse_square, inverse_distance));
+
+  const __m256 scaled_sin = _mm256_mul_ps(scale, harmonic_sin);
+  const __m256 strength = _mm256_mul_ps(scaled_sin, angular);
+  const __m256 direction_part = _mm256_xor_ps(scaled_sin, _mm256_and_ps(projection, sign_mask));
+  const __m256 phase_part = _mm256_fmadd_ps(_mm256_set1_ps(DISTANCE_PHASE_FACTOR), harmonic_cos,
+                                            _mm256_mul_ps(_mm256_set1_ps(3.),
+                                                          _mm256_mul_ps(harmonic_sin, inverse_distance)));
+  const __m256 radius_part = _mm256_mul_ps(_mm256_mul_ps(scale, angular),
+                                           _mm256_mul_ps(inverse_distance, phase_part));
+  const __m256 gradient_x = _mm256_fmsub_ps(direction_part, direction_x, _mm256_mul_ps(radius_part, radius_x));
+  const __m256 gradient_y = _mm256_fmsub_ps(direction_part, direction_y, _mm256_mul_ps(radius_part, radius_y));
+
+  lanes_sums[0] = _mm256_fnmadd_ps(radius_y, strength, lanes_sums[0]);
+  lanes_sums[1] = _mm256_fmadd_ps(radius_x, strength, lanes_sums[1]);
+  lanes_sums[2] = _mm256_fnmadd_ps(radius_y, gradient_x, lanes_sums[2]);
+  lanes_sums[3] = _mm256_sub_ps(lanes_sums[3], _mm256_fmadd_ps(radius_y, gradient_y, strength));
+  lanes_sums[4] = _mm256_add_ps(lanes_sums[4], _mm256_fmadd_ps(radius_x, gradient_x, strength));
+  lanes_sums[5] = _mm256_fmadd_ps(radius_x, gradient_y, lanes_sums[5]);
+  return;
+}
+
+
+__attribute__((target("avx2,fma"))) inline void StoreFieldJacobianAvx2(const __m256 *lanes_sums, float *sums)
+{
+  for (size_t part = 0; part < FIELD_JACOBIAN_SIZE; part++)
+  {
+    float lanes[8];
+    _mm256_storeu_ps(lanes, lanes_sums[part]);
+    sums[part] = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+  }
+  return;
+}
+
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) void FieldJacobianKernelAvx2(const PackView & pack, const size_t first,
+                                                                 const size_t last, const float point_x,
+                                                                 const float point_y, const float time_phase,
+                                                                 float *sums)
+{
+  const __m256 point_x_lanes = _mm256_set1_ps(point_x);
+  const __m256 point_y_lanes = _mm256_set1_ps(point_y);
+  const __m256 time_phase_lanes = _mm256_set1_ps(time_phase);
+
+  __m256 lanes_sums[FIELD_JACOBIAN_SIZE];
+  for (size_t part = 0; part < FIELD_JACOBIAN_SIZE; part++)
+  {
+    lanes_sums[part] = _mm256_setzero_ps( );
+  }
+
+  for (size_t ind = first; ind < last; ind += 8)
+  {
+    const __m256 radius_x = _mm256_sub_ps(point_x_lanes, _mm256_loadu_ps(pack.x + ind));
+    const __m256 radius_y = _mm256_sub_ps(point_y_lanes, _mm256_loadu_ps(pack.y + ind));
+    const __m256 square_distance = _mm256_fmadd_ps(radius_x, radius_x, _mm256_mul_ps(radius_y, radius_y));
+    const __m256 distance = _mm256_sqrt_ps(square_distance);
+    const __m256 inverse_distance = _mm256_div_ps(_mm256_set1_ps(1.), distance);
+
+    __m256 harmonic_sin;
+    __m256 harmonic_cos;
+    SinCosAvx2<accuracy>(_mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(DISTANCE_PHASE_FACTOR), distance,
+                                                        time_phase_lanes), _mm256_loadu_ps(pack.phase + ind)),
+                         &harmonic_sin, &harmonic_cos);
+
+    // Lanes after last and dipoles in the point give nothing.
+    const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(ind), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256 mask = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(last), lanes)),
+                                      _mm256_cmp_ps(square_distance, _mm256_setzero_ps( ), _CMP_NEQ_UQ));
+
+    AddFieldJacobianAvx2(pack, ind, mask, radius_x, radius_y, inverse_distance, harmonic_sin, harmonic_cos,
+                         lanes_sums);
+  }
+
+  StoreFieldJacobianAvx2(lanes_sums, sums);
+  return;
+}
+
+
+// Look at GetPathHarmonic( ). Anchors are loaded and stored only in lanes before last, so calls for disjoint ranges
+// of dipoles don't touch anchors of each other.
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) inline void GetPathHarmonicAvx2(const PackView & pack, const PathView & path,
+                                                                    const size_t ind, const __m256i last_mask,
+                                                                    const __m256 distance, const __m256 time_phase,
+                                                                    __m256 *harmonic_sin, __m256 *harmonic_cos)
+{
+  __m256 anchor_distance = _mm256_maskload_ps(path.anchor_distance + ind, last_mask);
+  __m256 anchor_sin = _mm256_maskload_ps(path.anchor_sin + ind, last_mask);
+  __m256 anchor_cos = _mm256_maskload_ps(path.anchor_cos + ind, last_mask);
+
+  __m256 rotation = _mm256_mul_ps(_mm256_set1_ps(DISTANCE_PHASE_FACTOR), _mm256_sub_ps(anchor_distance, distance));
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  const __m256 anchored_mask = _mm256_and_ps(_mm256_castsi256_ps(last_mask),
+                                             _mm256_cmp_ps(_mm256_and_ps(rotation, abs_mask),
+                                                           _mm256_set1_ps(PATH_PHASOR_MAX_ROTATION), _CMP_GT_OQ));
+
+  if (_mm256_movemask_ps(anchored_mask) != 0)
+  {
+    __m256 exact_sin;
+    __m256 exact_cos;
+    SinCosAvx2<accuracy>(_mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(DISTANCE_PHASE_FACTOR), distance,
+                                                        time_phase), _mm256_loadu_ps(pack.phase + ind)),
+                         &exact_sin, &exact_cos);
+
+    anchor_distance = _mm256_blendv_ps(anchor_distance, distance, anchored_mask);
+    anchor_sin = _mm256_blendv_ps(anchor_sin, exact_sin, anchored_mask);
+    anchor_cos = _mm256_blendv_ps(anchor_cos, exact_cos, anchored_mask);
+    rotation = _mm256_andnot_ps(anchored_mask, rotation);
+
+    const __m256i store_mask = _mm256_castps_si256(anchored_mask);
+    _mm256_maskstore_ps(path.anchor_distance + ind, store_mask, anchor_distance);
+    _mm256_maskstore_ps(path.anchor_sin + ind, store_mask, anchor_sin);
+    _mm256_maskstore_ps(path.anchor_cos + ind, store_mask, anchor_cos);
+  }
+
+  const __m256 square_rotation = _mm256_mul_ps(rotation, rotation);
+  const __m256 rotation_sin = _mm256_mul_ps(rotation, _mm256_fnmadd_ps(square_rotation, _mm256_set1_ps(1. / 6),
+                                                                       _mm256_set1_ps(1.)));
+  const __m256 rotation_cos = _mm256_fnmadd_ps(square_rotation,
+                                               _mm256_fnmadd_ps(square_rotation, _mm256_set1_ps(1. / 24),
+                                                                _mm256_set1_ps(0.5)),
+                                               _mm256_set1_ps(1.));
+
+  *harmonic_sin = _mm256_fmadd_ps(anchor_sin, rotation_cos, _mm256_mul_ps(anchor_cos, rotation_sin));
+  *harmonic_cos = _mm256_fmsub_ps(anchor_cos, rotation_cos, _mm256_mul_ps(anchor_sin, rotation_sin));
+  return;
+}
+
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) void PathFieldKernelAvx2(const PackView & pack, const PathView & path,
+                                                             const size_t first, const size_t last,
+                                                             const float point_x, const float point_y,
+                                                             const float time_phase, float *field_x, float *field_y)
+{
+  const __m256 point_x_lanes = _mm256_set1_ps(point_x);
+  const __m256 point_y_lanes = _mm256_set1_ps(point_y);
+  const __m256 time_phase_lanes = _mm256_set1_ps(time_phase);
+  const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+  __m256 sum_x = _mm256_setzero_ps( );
+  __m256 sum_y = _mm256_setzero_ps( );
+
+  for (size_t ind = first; ind < last; ind += 8)
+  {
+    const __m256 radius_x = _mm256_sub_ps(point_x_lanes, _mm256_loadu_ps(pack.x + ind));
+    const __m256 radius_y = _mm256_sub_ps(point_y_lanes, _mm256_loadu_ps(pack.y + ind));
+    const __m256 square_distance = _mm256_fmadd_ps(radius_x, radius_x, _mm256_mul_ps(radius_y, radius_y));
+    const __m256 distance = _mm256_sqrt_ps(square_distance);
+    const __m256 inverse_distance = _mm256_div_ps(_mm256_set1_ps(1.), distance);
+
+    const __m256 projection = _mm256_fmadd_ps(radius_x, _mm256_loadu_ps(pack.direction_x + ind),
+                                              _mm256_mul_ps(radius_y, _mm256_loadu_ps(pack.direction_y + ind)));
+    const __m256 angular_coefficient = _mm256_mul_ps(_mm256_and_ps(projection, abs_mask), inverse_distance);
+
+    const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(ind), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i last_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(last), lanes);
+
+    __m256 harmonic_sin;
+    __m256 harmonic_cos;
+    GetPathHarmonicAvx2<accuracy>(pack, path, ind, last_mask, distance, time_phase_lanes, &harmonic_sin,
+                                  &harmonic_cos);
+
+    __m256 field_strength = _mm256_mul_ps(_mm256_loadu_ps(pack.amplitude + ind), angular_coefficient);
+    field_strength = _mm256_mul_ps(_mm256_mul_ps(field_strength, harmonic_sin), _mm256_set1_ps(DISTANT_SCALE));
+    field_strength = _mm256_mul_ps(_mm256_mul_ps(field_strength, inverse_distance), inverse_distance);
+
+    // Lanes after last and dipoles in the point give nothing.
+    const __m256 mask = _mm256_and_ps(_mm256_castsi256_ps(last_mask),
+                                      _mm256_cmp_ps(square_distance, _mm256_setzero_ps( ), _CMP_NEQ_UQ));
+
+    sum_x = _mm256_sub_ps(sum_x, _mm256_and_ps(mask, _mm256_mul_ps(radius_y, field_strength)));
+    sum_y = _mm256_add_ps(sum_y, _mm256_and_ps(mask, _mm256_mul_ps(radius_x, field_strength)));
+  }
+
+  __m128 half_x = _mm_add_ps(_mm256_castps256_ps128(sum_x), _mm256_extractf128_ps(sum_x, 1));
+  __m128 half_y = _mm_add_ps(_mm256_castps256_ps128(sum_y), _mm256_extractf128_ps(sum_y, 1));
+  half_x = _mm_hadd_ps(half_x, half_y);
+  half_x = _mm_hadd_ps(half_x, half_x);
+
+  *field_x = _mm_cvtss_f32(half_x);
+  *field_y = _mm_cvtss_f32(_mm_shuffle_ps(half_x, half_x, 1));
+  return;
+}
+
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) void PathFieldJacobianKernelAvx2(const PackView & pack, const PathView & path,
+                                                                     const size_t first, const size_t last,
+                                                                     const float point_x, const float point_y,
+                                                                     const float time_phase, float *sums)
+{
+  const __m256 point_x_lanes = _mm256_set1_ps(point_x);
+  const __m256 point_y_lanes = _mm256_set1_ps(point_y);
+  const __m256 time_phase_lanes = _mm256_set1_ps(time_phase);
+
+  __m256 lanes_sums[FIELD_JACOBIAN_SIZE];
+  for (size_t part = 0; part < FIELD_JACOBIAN_SIZE; part++)
+  {
+    lanes_sums[part] = _mm256_setzero_ps( );
+  }
+
+  for (size_t ind = first; ind < last; ind += 8)
+  {
+    const __m256 radius_x = _mm256_sub_ps(point_x_lanes, _mm256_loadu_ps(pack.x + ind));
+    const __m256 radius_y = _mm256_sub_ps(point_y_lanes, _mm256_loadu_ps(pack.y + ind));
+    const __m256 square_distance = _mm256_fmadd_ps(radius_x, radius_x, _mm256_mul_ps(radius_y, radius_y));
+    const __m256 distance = _mm256_sqrt_ps(square_distance);
+    const __m256 inverse_distance = _mm256_div_ps(_mm256_set1_ps(1.), distance);
+
+    const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(ind), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i last_mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(last), lanes);
+
+    __m256 harmonic_sin;
+    __m256 harmonic_cos;
+    GetPathHarmonicAvx2<accuracy>(pack, path, ind, last_mask, distance, time_phase_lanes, &harmonic_sin,
+                                  &harmonic_cos);
+
+    const __m256 mask = _mm256_and_ps(_mm256_castsi256_ps(last_mask),
+                                      _mm256_cmp_ps(square_distance, _mm256_setzero_ps( ), _CMP_NEQ_UQ));
+
+    AddFieldJacobianAvx2(pack, ind, mask, radius_x, radius_y, inverse_distance, harmonic_sin, harmonic_cos,
+                         lanes_sums);
+  }
+
+  StoreFieldJacobianAvx2(lanes_sums, sums);
+  return;
+}
+
+
+// ln(x) of positive x: x = mantissa * 2^exponent with mantissa in [sqrt(0.5), sqrt(2)) and
+// ln(mantissa) = 2 * atanh(s) = 2 * (s + s^3 / 3 + ...), s = (mantissa - 1) / (mantissa + 1), |s| < 0.172.
+__attribute__((target("avx2,fma"))) inline __m256 LogAvx2(const __m256 x)
+{
+  const __m256i bits = _mm256_castps_si256(x);
+  __m256i exponent = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+  __m256 mantissa = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                                        _mm256_set1_epi32(0x3f800000)));
+
+  // Mantissa in [1, 2) is halved over sqrt(2). True lanes of mask are -1, so exponent is increased by them.
+  const __m256 is_halved = _mm256_cmp_ps(mantissa, _mm256_set1_ps(1.41421356), _CMP_GT_OQ);
+  mantissa = _mm256_blendv_ps(mantissa, _mm256_mul_ps(mantissa, _mm256_set1_ps(0.5)), is_halved);
+  exponent = _mm256_sub_epi32(exponent, _mm256_castps_si256(is_halved));
+
+  const __m256 s = _mm256_div_ps(_mm256_sub_ps(mantissa, _mm256_set1_ps(1.)),
+                                 _mm256_add_ps(mantissa, _mm256_set1_ps(1.)));
+  const __m256 square_s = _mm256_mul_ps(s, s);
+  __m256 polynomial = _mm256_fmadd_ps(square_s, _mm256_set1_ps(2. / 9), _mm256_set1_ps(2. / 7));
+  polynomial = _mm256_fmadd_ps(polynomial, square_s, _mm256_set1_ps(2. / 5));
+  polynomial = _mm256_fmadd_ps(polynomial, square_s, _mm256_set1_ps(2. / 3));
+  polynomial = _mm256_fmadd_ps(polynomial, square_s, _mm256_set1_ps(2.));
+
+  return _mm256_fmadd_ps(_mm256_cvtepi32_ps(exponent), _mm256_set1_ps(0.693147181), _mm256_mul_ps(s, polynomial));
+}
+
+
+// Look at FrontKernelScalar( ).
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) void FrontKernelAvx2(const PackView & pack, const size_t first,
+                                                         const size_t last, const float point_x,
+                                                         const float point_y, float *in_phase_part,
+                                                         float *quadrature_part)
+{
+  const __m256 point_x_lanes = _mm256_set1_ps(point_x);
+  const __m256 point_y_lanes = _mm256_set1_ps(point_y);
+  const __m256i last_lanes = _mm256_set1_epi32(last);
+
+  __m256 in_phase_sum = _mm256_setzero_ps( );
+  __m256 quadrature_sum = _mm256_setzero_ps( );
+
+  for (size_t ind = first; ind < last; ind += 8)
+  {
+    const __m256 radius_x = _mm256_sub_ps(point_x_lanes, _mm256_loadu_ps(pack.x + ind));
+    const __m256 radius_y = _mm256_sub_ps(point_y_lanes, _mm256_loadu_ps(pack.y + ind));
+    const __m256 square_distance = _mm256_fmadd_ps(radius_x, radius_x, _mm256_mul_ps(radius_y, radius_y));
+
+    // Lanes after last and dipoles in the point give nothing. They get distance 1 instead of 0 for ln.
+    const __m256i lanes = _mm256_add_epi32(_mm256_set1_epi32(ind), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256 mask = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(last_lanes, lanes)),
+                                      _mm256_cmp_ps(square_distance, _mm256_setzero_ps( ), _CMP_NEQ_UQ));
+    const __m256 lanes_square_distance = _mm256_blendv_ps(_mm256_set1_ps(1.), square_distance, mask);
+
+    const __m256 scale = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(pack.amplitude + ind),
+                                                     _mm256_set1_ps(DISTANT_SCALE * 0.5)),
+                                       LogAvx2(lanes_square_distance));
+
+    __m256 harmonic_sin;
+    __m256 harmonic_cos;
+    SinCosAvx2<accuracy>(_mm256_fnmadd_ps(_mm256_set1_ps(DISTANCE_PHASE_FACTOR),
+                                          _mm256_sqrt_ps(lanes_square_distance), _mm256_loadu_ps(pack.phase + ind)),
+                         &harmonic_sin, &harmonic_cos);
+
+    in_phase_sum = _mm256_add_ps(in_phase_sum, _mm256_and_ps(mask, _mm256_mul_ps(scale, harmonic_sin)));
+    quadrature_sum = _mm256_add_ps(quadrature_sum, _mm256_and_ps(mask, _mm256_mul_ps(scale, harmonic_cos)));
+  }
+
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(in_phase_sum), _mm256_extractf128_ps(in_phase_sum, 1));
+  const __m128 quadrature_half = _mm_add_ps(_mm256_castps256_ps128(quadrature_sum),
+                                            _mm256_extractf128_ps(quadrature_sum, 1));
+  half = _mm_hadd_ps(half, quadrature_half);
+  half = _mm_hadd_ps(half, half);
+
+  *in_phase_part = _mm_cvtss_f32(half);
+  *quadrature_part = _mm_cvtss_f32(_mm_shuffle_ps(half, half, 1));
+  return;
+}
+
+#endif /* FAST_TRIG_X86 */
+
+
+SIMD_LEVELS DetectSimdLevel(void)
+{
+  #ifdef FAST_TRIG_X86
+  __builtin_cpu_init( );
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+  {
+    return AVX2_LEVEL;
+  }
+  return SSE2_LEVEL;
+  #else
+  return SCALAR_LEVEL;
+  #endif /* FAST_TRIG_X86 */
+}
+
+
+template <TRIG_ACCURACIES accuracy>
+FieldKernel ChooseFieldKernel(const SIMD_LEVELS simd_level)
+{
+  switch (simd_level)
+  {
+    #ifdef FAST_TRIG_X86
+    case AVX2_LEVEL:
+      return FieldKernelAvx2<accuracy>;
+    case SSE2_LEVEL:
+      return FieldKernelSse2<accuracy>;
+    #endif /* FAST_TRIG_X86 */
+    default:
+      return FieldKernelScalar;
+  }
+}
+
+// Jacobian kernel has AVX2 version only. SSE2 level uses scalar one.
+template <TRIG_ACCURACIES accuracy>
+FieldJacobianKernel ChooseFieldJacobianKernel(const SIMD_LEVELS simd_level)
+{
+  #ifdef FAST_TRIG_X86
+  if (simd_level == AVX2_LEVEL)
+  {
+    return FieldJacobianKernelAvx2<accuracy>;
+  }
+  #endif /* FAST_TRIG_X86 */
+  return FieldJacobianKernelScalar;
+}
+
+// Path kernels have AVX2 versions only too.
+template <TRIG_ACCURACIES accuracy>
+PathFieldKernel ChoosePathFieldKernel(const SIMD_LEVELS simd_level)
+{
+  #ifdef FAST_TRIG_X86
+  if (simd_level == AVX2_LEVEL)
+  {
+    return PathFieldKernelAvx2<accuracy>;
+  }
+  #endif /* FAST_TRIG_X86 */
+  return PathFieldKernelScalar;
+}
+
+template <TRIG_ACCURACIES accuracy>
+PathFieldJacobianKernel ChoosePathFieldJacobianKernel(const SIMD_LEVELS simd_level)
+{
+  #ifdef FAST_TRIG_X86
+  if (simd_level == AVX2_LEVEL)
+  {
+    return PathFieldJacobianKernelAvx2<accuracy>;
+  }
+  #endif /* FAST_TRIG_X86 */
+  return PathFieldJacobianKernelScalar;
+}
+
+// Front kernel has AVX2 version only too.
+template <TRIG_ACCURACIES accuracy>
+FrontKernel ChooseFrontKernel(const SIMD_LEVELS simd_level)
+{
+  #ifdef FAST_TRIG_X86
+  if (simd_level == AVX2_LEVEL)
+  {
+    return FrontKernelAvx2<accuracy>;
+  }
+  #endif /* FAST_TRIG_X86 */
+  return FrontKernelScalar;
+}
+
+// Kernels are chosen once at start of the program. REFERENCE_TRIG uses sin of libm, so it hasn't SIMD kernel.
+const SIMD_LEVELS simd_level = DetectSimdLevel( );
+const FieldKernel field_kernels[TRIG_ACCURACIES_NUMBER] = {ChooseFieldKernel<FAST_TRIG>(simd_level),
+                                                           ChooseFieldKernel<APPROXIMATE_TRIG>(simd_level),
+                                                           FieldKernelScalar};
+const FieldJacobianKernel field_jacobian_kernels[TRIG_ACCURACIES_NUMBER] =
+    {ChooseFieldJacobianKernel<FAST_TRIG>(simd_level), ChooseFieldJacobianKernel<APPROXIMATE_TRIG>(simd_level),
+     FieldJacobianKernelScalar};
+const PathFieldKernel path_field_kernels[TRIG_ACCURACIES_NUMBER] =
+    {ChoosePathFieldKernel<FAST_TRIG>(simd_level), ChoosePathFieldKernel<APPROXIMATE_TRIG>(simd_level),
+     PathFieldKernelScalar};
+const PathFieldJacobianKernel path_field_jacobian_kernels[TRIG_ACCURACIES_NUMBER] =
+    {ChoosePathFieldJacobianKernel<FAST_TRIG>(simd_level),
+     ChoosePathFieldJacobianKernel<APPROXIMATE_TRIG>(simd_level), PathFieldJacobianKernelScalar};
+const FrontKernel front_kernels[TRIG_ACCURACIES_NUMBER] = {ChooseFrontKernel<FAST_TRIG>(simd_level),
+                                                           ChooseFrontKernel<APPROXIMATE_TRIG>(simd_level),
+                                                           FrontKernelScalar};
+
+} // End of anonymous namespace.
+
+
+PathPhasors::PathPhasors(void)
+    :  time_phase_(0.)  {
+}
+
+
+DipolePack::DipolePack(void)
+    :  size_(0)  {
+  Clear( );
+}
+
+void DipolePack::Clear(void)
+{
+  size_ = 0;
+
+  x_.assign(DIPOLE_PACK_PADDING, DIPOLE_PACK_PADDING_POSITION);
+  y_.assign(DIPOLE_PACK_PADDING, DIPOLE_PACK_PADDING_POSITION);
+  direction_x_.assign(DIPOLE_PACK_PADDING, 0.);
+  direction_y_.assign(DIPOLE_PACK_PADDING, 0.);
+  phase_.assign(DIPOLE_PACK_PADDING, 0.);
+  amplitude_.assign(DIPOLE_PACK_PADDING, 0.);
+  return;
+}
+
+void DipolePack::Push(const Dipole & dipole)
+{
+  const Vector2 position = dipole.GetPosition( );
+  // The same vector as in Dipole::GetFieldStrength( ): multiples of 90 degrees give exact axes.
+  const Vector2 direction = Vector2(1, 0).GetRotated(dipole.GetDirection( ));
+
+  // Padding stays after the last dipole.
+  x_.insert(x_.begin( ) + size_, position.GetX( ));
+  y_.insert(y_.begin( ) + size_, position.GetY( ));
+  direction_x_.insert(direction_x_.begin( ) + size_, direction.GetX( ));
+  direction_y_.insert(direction_y_.begin( ) + size_, direction.GetY( ));
+  phase_.insert(phase_.begin( ) + size_, dipole.GetPhase( ) * ONE_RADIAN);
+  amplitude_.insert(amplitude_.begin( ) + size_, dipole.GetAmplitude( ));
+  size_++;
+
+  #ifdef DIPOLE_PACK_DEBUG
+  Dump( );
+  #endif /* DIPOLE_PACK_DEBUG */
+
+  return;
+}
+
+void DipolePack::Push(const DipolePack & that, const size_t ind)
+{
+  assert(ind < that.size_);
+
+  x_.insert(x_.begin( ) + size_, that.x_[ind]);
+  y_.insert(y_.begin( ) + size_, that.y_[ind]);
+  direction_x_.insert(direction_x_.begin( ) + size_, that.direction_x_[ind]);
+  direction_y_.insert(direction_y_.begin( ) + size_, that.direction_y_[ind]);
+  phase_.insert(phase_.begin( ) + size_, that.phase_[ind]);
+  amplitude_.insert(amplitude_.begin( ) + size_, that.amplitude_[ind]);
+  size_++;
+
+  return;
+}
+
+void DipolePack::Remove(const size_t ind)
+{
+  assert(ind < size_);
+
+  x_.erase(x_.begin( ) + ind);
+  y_.erase(y_.begin( ) + ind);
+  direction_x_.erase(direction_x_.begin( ) + ind);
+  direction_y_.erase(direction_y_.begin( ) + ind);
+  phase_.erase(phase_.begin( ) + ind);
+  amplitude_.erase(amplitude_.begin( ) + ind);
+  size_--;
+
+  return;
+}
+
+size_t DipolePack::Size(void) const
+{
+  return size_;
+}
+
+SIMD_LEVELS DipolePack::GetSimdLevel(void)
+{
+  return simd_level;
+}
+
+Vector2 DipolePack::GetFieldStrength(const Vector2 & point, const float t, const size_t first,
+                                     const size_t last) const
+{
+  assert(first <= last && last <= size_);
+
+  if (first == last)
+  {
+    return Vector2(0., 0.);
+  }
+
+  const PackView pack = {x_.data( ), y_.data( ), direction_x_.data( ), direction_y_.data( ), phase_.data( ),
+                         amplitude_.data( )};
+  const float time_phase = GetTimePhase(t);
+
+  float field_x = 0.;
+  float field_y = 0.;
+  field_kernels[GetTrigAccuracy( )](pack, first, last, point.GetX( ), point.GetY( ), time_phase, &field_x, &field_y);
+
+  return Vector2(field_x, field_y);
+}
+
+Vector2 DipolePack::GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last,
+                                     FieldJacobian *jacobian) const
+{
+  assert(first <= last && last <= size_);
+  assert(jacobian != nullptr);
+
+  const PackView pack = {x_.data( ), y_.data( ), direction_x_.data( ), direction_y_.data( ), phase_.data( ),
+                         amplitude_.data( )};
+  const float time_phase = GetTimePhase(t);
+
+  float sums[FIELD_JACOBIAN_SIZE] = {0., 0., 0., 0., 0., 0.};
+  if (first != last)
+  {
+    field_jacobian_kernels[GetTrigAccuracy( )](pack, first, last, point.GetX( ), point.GetY( ), time_phase, sums);
+  }
+
+  jacobian -> x_derivative = Vector2(sums[2], sums[4]);
+  jacobian -> y_derivative = Vector2(sums[3], sums[5]);
+  return Vector2(sums[0], sums[1]);
+}
+
+void DipolePack::StartPath(PathPhasors *path, const float t) const
+{
+  assert(path != nullptr);
+
+  path -> time_phase_ = GetTimePhase(t);
+  path -> anchor_distance_.assign(x_.size( ), PATH_UNANCHORED_DISTANCE);
+  path -> anchor_sin_.assign(x_.size( ), 0.);
+  path -> anchor_cos_.assign(x_.size( ), 0.);
+  return;
+}
+
+Vector2 DipolePack::GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last,
+                                     PathPhasors *path) const
+{
+  assert(first <= last && last <= size_);
+  assert(path != nullptr && path -> anchor_distance_.size( ) == x_.size( ));
+
+  if (first == last)
+  {
+    return Vector2(0., 0.);
+  }
+
+  const PackView pack = {x_.data( ), y_.data( ), direction_x_.data( ), direction_y_.data( ), phase_.data( ),
+                         amplitude_.data( )};
+  const PathView path_view = {path -> anchor_distance_.data( ), path -> anchor_sin_.data( ),
+                              path -> anchor_cos_.data( )};
+  const float time_phase = GetTimePhase(t);
+  assert(time_phase == path -> time_phase_);
+
+  float field_x = 0.;
+  float field_y = 0.;
+  path_field_kernels[GetTrigAccuracy( )](pack, path_view, first, last, point.GetX( ), point.GetY( ), time_phase,
+                                         &field_x, &field_y);
+
+  return Vector2(field_x, field_y);
+}
+
+Vector2 DipolePack::GetFieldStrength(const Vector2 & point, const float t, const size_t first, const size_t last,
+                                     FieldJacobian *jacobian, PathPhasors *path) const
+{
+  assert(first <= last && last <= size_);
+  assert(jacobian != nullptr);
+  assert(path != nullptr && path -> anchor_distance_.size( ) == x_.size( ));
+
+  const PackView pack = {x_.data( ), y_.data( ), direction_x_.data( ), direction_y_.data( ), phase_.data( ),
+                         amplitude_.data( )};
+  const PathView path_view = {path -> anchor_distance_.data( ), path -> anchor_sin_.data( ),
+                              path -> anchor_cos_.data( )};
+  const float time_phase = GetTimePhase(t);
+  assert(time_phase == path -> time_phase_);
+
+  float sums[FIELD_JACOBIAN_SIZE] = {0., 0., 0., 0., 0., 0.};
+  if (first != last)
+  {
+    path_field_jacobian_kernels[GetTrigAccuracy( )](pack, path_view, first, last, point.GetX( ), point.GetY( ),
+                                                    time_phase, sums);
+  }
+
+  jacobian -> x_derivative = Vector2(sums[2], sums[4]);
+  jacobian -> y_derivative = Vector2(sums[3], sums[5]);
+  return Vector2(sums[0], sums[1]);
+}
+
+Vector2 DipolePack::GetFieldStrength(const Vector2 & point, const float t) const
+{
+  return GetFieldStrength(point, t, 0, size_);
+}
+
+void DipolePack::GetFieldStrength(const Vector2 *points, Vector2 *field_strengths, const size_t points_number,
+                                  const float t) const
+{
+  GetFieldStrengthByPhase(points, field_strengths, points_number, GetTimePhase(t), 0, size_);
+  return;
+}
+
+void DipolePack::GetPhasors(const Vector2 *points, Vector2 *in_phase_parts, Vector2 *quadrature_parts,
+                            const size_t points_number, const size_t first, const size_t last) const
+{
+  // sin(time_phase + phase) = sin(phase) * cos(time_phase) + sin(phase + PI / 2) * sin(time_phase).
+  GetFieldStrengthByPhase(points, in_phase_parts, points_number, 0., first, last);
+  GetFieldStrengthByPhase(points, quadrature_parts, points_number, PI / 2, first, last);
+  return;
+}
+
+void DipolePack::GetFrontPhasors(const Vector2 *points, float *in_phase_parts, float *quadrature_parts,
+                                 const size_t points_number, const size_t first, const size_t last) const
+{
+  assert(points != nullptr || points_number == 0);
+  assert(in_phase_parts != nullptr || points_number == 0);
+  assert(quadrature_parts != nullptr || points_number == 0);
+  assert(first <= last && last <= size_);
+
+  const PackView pack = {x_.data( ), y_.data( ), direction_x_.data( ), direction_y_.data( ), phase_.data( ),
+                         amplitude_.data( )};
+  const FrontKernel front_kernel = front_kernels[GetTrigAccuracy( )];
+
+  for (size_t ind = 0; ind < points_number; ind++)
+  {
+    front_kernel(pack, first, last, points[ind].GetX( ), points[ind].GetY( ), &in_phase_parts[ind],
+                 &quadrature_parts[ind]);
+  }
+
+  return;
+}
+
+Vector2 DipolePack::GetPosition(const size_t ind) const
+{
+  assert(ind < size_);
+  return Vector2(x_[ind], y_[ind]);
+}
+
+Vector2 DipolePack::GetDirectionVector(const size_t ind) const
+{
+  assert(ind < size_);
+  return Vector2(direction_x_[ind], direction_y_[ind]);
+}
+
+float DipolePack::GetPhase(const size_t ind) const
+{
+  assert(ind < size_);
+  return phase_[ind];
+}
+
+float DipolePack::GetAmplitude(const size_t ind) const
+{
+  assert(ind < size_);
+  return amplitude_[ind];
+}
+
+void DipolePack::GetFieldStrengthByPhase(const Vector2 *points, Vector2 *field_strengths, const size_t points_number,
+                                         const float time_phase, const size_t first, const size_t last) const
+{
+  assert(points != nullptr);
+  assert(field_strengths != nullptr);
+  assert(first <= last && last <= size_);
+
+  const PackView pack = {x_.data( ), y_.data( ), direction_x_.data( ), direction_y_.data( ), phase_.data( ),
+                         amplitude_.data( )};
+  const FieldKernel kernel = field_kernels[GetTrigAccuracy( )];
+
+  float points_x[FIELD_POINTS_TILE];
+  float points_y[FIELD_POINTS_TILE];
+  float sum_x[FIELD_POINTS_TILE];
+  float sum_y[FIELD_POINTS_TILE];
+
+  for (size_t points_begin = 0; points_begin < points_number; points_begin += FIELD_POINTS_TILE)
+  {
+    const size_t tile_size = std::min(FIELD_POINTS_TILE, points_number - points_begin);
+    for (size_t ind = 0; ind < tile_size; ind++)
+    {
+      points_x[ind] = points[points_begin + ind].GetX( );
+      points_y[ind] = points[points_begin + ind].GetY( );
+      sum_x[ind] = 0.;
+      sum_y[ind] = 0.;
+    }
+
+    for (size_t dipoles_begin = first; dipoles_begin < last; dipoles_begin += FIELD_DIPOLES_TILE)
+    {
+      const size_t dipoles_end = std::min(dipoles_begin + FIELD_DIPOLES_TILE, last);
+      for (size_t ind = 0; ind < tile_size; ind++)
+      {
+        float field_x = 0.;
+        float field_y = 0.;
+        kernel(pack, dipoles_begin, dipoles_end, points_x[ind], points_y[ind], time_phase, &field_x, &field_y);
+        sum_x[ind] += field_x;
+        sum_y[ind] += field_y;
+      }
+    }
+
+    for (size_t ind = 0; ind < tile_size; ind++)
+    {
+      field_strengths[points_begin + ind] = Vector2(sum_x[ind], sum_y[ind]);
+    }
+  }
+
+  return;
+}
+
+bool DipolePack::Dump(void) const
+{
+  std::cout << "DipolePack: " << size_ << " dipoles, simd level " << simd_level << std::endl;
+  for (size_t ind = 0; ind < size_; ind++)
+  {
+    std::cout << "\t" << x_[ind] << " " << y_[ind] << " direction: " << direction_x_[ind] << " " <<
+                 direction_y_[ind] << " phase: " << phase_[ind] << " amplitude: " << amplitude_[ind] << std::endl;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
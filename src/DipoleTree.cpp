@@ -0,0 +1,309 @@
+#include "DipoleTree.h"
+#include "FastTrig.h"
+
+#include <algorithm>
+
+namespace my_math
+{
+
+// Every level adds not more than 4 nodes to stack of GetFieldStrength( ).
+const size_t DIPOLE_TREE_STACK_SIZE = 4 * DIPOLE_TREE_MAX_DEPTH + 4;
+
+DipoleTree::DipoleTree(void)
+    :  is_valid_(false)  {
+}
+
+void DipoleTree::Build(const DipolePack & dipoles)
+{
+  dipoles_.Clear( );
+  nodes_.clear( );
+  groups_.clear( );
+
+  const size_t dipoles_number = dipoles.Size( );
+  if (dipoles_number != 0)
+  {
+    std::vector<size_t> indices(dipoles_number);
+    for (size_t ind = 0; ind < dipoles_number; ind++)
+    {
+      indices[ind] = ind;
+    }
+
+    nodes_.push_back(Node( ));
+    BuildNode(0, dipoles, indices, 0, dipoles_number, 0);
+  }
+
+  is_valid_ = true;
+
+  #ifdef DIPOLE_TREE_DEBUG
+  Dump( );
+  #endif /* DIPOLE_TREE_DEBUG */
+
+  return;
+}
+
+void DipoleTree::BuildNode(const size_t node_ind, const DipolePack & source, std::vector<size_t> & indices,
+                           const size_t begin, const size_t end, const int depth)
+{
+  assert(begin < end);
+
+  // Center of node is center of box around its dipoles.
+  float left = source.GetPosition(indices[begin]).GetX( );
+  float right = left;
+  float top = source.GetPosition(indices[begin]).GetY( );
+  float bottom = top;
+  for (size_t ind = begin + 1; ind < end; ind++)
+  {
+    const Vector2 position = source.GetPosition(indices[ind]);
+    left = std::min(left, position.GetX( ));
+    right = std::max(right, position.GetX( ));
+    top = std::min(top, position.GetY( ));
+    bottom = std::max(bottom, position.GetY( ));
+  }
+
+  const float center_x = (left + right) / 2;
+  const float center_y = (top + bottom) / 2;
+
+  float square_radius = 0.;
+  for (size_t ind = begin; ind < end; ind++)
+  {
+    const Vector2 radius = source.GetPosition(indices[ind]) - Vector2(center_x, center_y);
+    square_radius = std::max(square_radius, radius.GetX( ) * radius.GetX( ) + radius.GetY( ) * radius.GetY( ));
+  }
+
+  nodes_[node_ind].center_x = center_x;
+  nodes_[node_ind].center_y = center_y;
+  nodes_[node_ind].radius = sqrt(square_radius);
+  nodes_[node_ind].first = dipoles_.Size( );
+  nodes_[node_ind].first_child = 0;
+  nodes_[node_ind].children_number = 0;
+
+  const bool is_leaf = end - begin <= DIPOLE_TREE_LEAF_SIZE || depth >= DIPOLE_TREE_MAX_DEPTH ||
+                       (left == right && top == bottom);
+
+  if (is_leaf)
+  {
+    for (size_t ind = begin; ind < end; ind++)
+    {
+      dipoles_.Push(source, indices[ind]);
+    }
+  }
+  else
+  {
+    // Split dipoles in quarters of box: left-top, right-top, left-bottom, right-bottom.
+    size_t bounds[5] = {begin, 0, 0, 0, end};
+    bounds[2] = std::partition(indices.begin( ) + begin, indices.begin( ) + end, [&](const size_t ind) {
+      return source.GetPosition(ind).GetY( ) < center_y;
+    }) - indices.begin( );
+    bounds[1] = std::partition(indices.begin( ) + begin, indices.begin( ) + bounds[2], [&](const size_t ind) {
+      return source.GetPosition(ind).GetX( ) < center_x;
+    }) - indices.begin( );
+    bounds[3] = std::partition(indices.begin( ) + bounds[2], indices.begin( ) + end, [&](const size_t ind) {
+      return source.GetPosition(ind).GetX( ) < center_x;
+    }) - indices.begin( );
+
+    size_t children_number = 0;
+    for (int quarter = 0; quarter < 4; quarter++)
+    {
+      children_number += bounds[quarter] < bounds[quarter + 1];
+    }
+
+    // nodes_ can be reallocated, so node is got by index every time.
+    const size_t first_child = nodes_.size( );
+    nodes_[node_ind].first_child = first_child;
+    nodes_[node_ind].children_number = children_number;
+    nodes_.resize(first_child + children_number);
+
+    size_t child_ind = first_child;
+    for (int quarter = 0; quarter < 4; quarter++)
+    {
+      if (bounds[quarter] < bounds[quarter + 1])
+      {
+        BuildNode(child_ind, source, indices, bounds[quarter], bounds[quarter + 1], depth + 1);
+        child_ind++;
+      }
+    }
+  }
+
+  nodes_[node_ind].last = dipoles_.Size( );
+  BuildGroups(nodes_[node_ind]);
+
+  return;
+}
+
+void DipoleTree::BuildGroups(Node & node)
+{
+  node.first_group = groups_.size( );
+
+  for (size_t ind = node.first; ind < node.last; ind++)
+  {
+    const Vector2 direction = dipoles_.GetDirectionVector(ind);
+    const float amplitude = dipoles_.GetAmplitude(ind);
+    const float phase = dipoles_.GetPhase(ind);
+
+    // Directions are set in degrees by user, so equal directions have equal vectors.
+    size_t group_ind = node.first_group;
+    while (group_ind < groups_.size( ) && (groups_[group_ind].direction_x != direction.GetX( ) ||
+                                           groups_[group_ind].direction_y != direction.GetY( )))
+    {
+      group_ind++;
+    }
+
+    if (group_ind == groups_.size( ))
+    {
+      if (groups_.size( ) - node.first_group == DIPOLE_TREE_MAX_DIRECTIONS)
+      {
+        groups_.resize(node.first_group);
+        break;
+      }
+      groups_.push_back(DirectionGroup{direction.GetX( ), direction.GetY( ), 0., 0., 0.});
+    }
+
+    const std::complex<float> complex_amplitude = std::polar(amplitude, phase);
+    const Vector2 shift = dipoles_.GetPosition(ind) - Vector2(node.center_x, node.center_y);
+    groups_[group_ind].amplitude += complex_amplitude;
+    groups_[group_ind].moment_x += complex_amplitude * shift.GetX( );
+    groups_[group_ind].moment_y += complex_amplitude * shift.GetY( );
+  }
+
+  node.last_group = groups_.size( );
+  return;
+}
+
+void DipoleTree::Invalidate(void)
+{
+  is_valid_ = false;
+  return;
+}
+
+bool DipoleTree::IsValid(void) const
+{
+  return is_valid_;
+}
+
+Vector2 DipoleTree::GetFieldStrength(const Vector2 & point, const float t, const float tolerance) const
+{
+  assert(is_valid_);
+
+  if (nodes_.empty( ))
+  {
+    return Vector2(0., 0.);
+  }
+
+  const float time_phase = GetTimePhase(t);
+  const float point_x = point.GetX( );
+  const float point_y = point.GetY( );
+
+  Vector2 result(0., 0.);
+
+  size_t stack[DIPOLE_TREE_STACK_SIZE];
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size != 0)
+  {
+    const Node & node = nodes_[stack[--stack_size]];
+
+    const float radius_x = point_x - node.center_x;
+    const float radius_y = point_y - node.center_y;
+    const float distance = sqrt(radius_x * radius_x + radius_y * radius_y);
+
+    // Shift of dipole by radius changes 1 / distance, direction of field and angular coefficient by
+    // radius / (distance - radius) each and phase by DISTANCE_PHASE_FACTOR * radius. First order is taken into
+    // account, so error is about square of it.
+    const float shift_error = node.radius * (3 + DISTANCE_PHASE_FACTOR * distance) / (distance - node.radius);
+    bool is_far = node.first_group != node.last_group && distance > node.radius &&
+                  shift_error * shift_error <= tolerance;
+
+    // Expansion of |radius * direction| is wrong if its sign isn't the same for all dipoles.
+    for (size_t group_ind = node.first_group; is_far && group_ind < node.last_group; group_ind++)
+    {
+      is_far = fabs(radius_x * groups_[group_ind].direction_x + radius_y * groups_[group_ind].direction_y) >
+               node.radius;
+    }
+
+    if (is_far)
+    {
+      // Field of group is DISTANT_SCALE * Im(harmonic * (rotated_radius * radial_part - |angular| * rotated_moment)),
+      // where angular = radius * direction and harmonic = exp(i * (time_phase - DISTANCE_PHASE_FACTOR * distance)) /
+      // distance^3. Look at Dipole::GetFieldStrength( ).
+      const float inverse_distance = 1. / distance;
+      float harmonic_sin = 0.;
+      float harmonic_cos = 0.;
+      FastSinCos(time_phase - DISTANCE_PHASE_FACTOR * distance, &harmonic_sin, &harmonic_cos);
+      const float inverse_cube = inverse_distance * inverse_distance * inverse_distance;
+      const std::complex<float> harmonic(inverse_cube * harmonic_cos, inverse_cube * harmonic_sin);
+      const std::complex<float> distance_factor(3 * inverse_distance * inverse_distance,
+                                                DISTANCE_PHASE_FACTOR * inverse_distance);
+
+      std::complex<float> radial_part = 0.;
+      std::complex<float> rotated_moment_x = 0.;
+      std::complex<float> rotated_moment_y = 0.;
+      for (size_t group_ind = node.first_group; group_ind < node.last_group; group_ind++)
+      {
+        const DirectionGroup & group = groups_[group_ind];
+        const float angular = radius_x * group.direction_x + radius_y * group.direction_y;
+        const float angular_sign = angular > 0 ? 1. : -1.;
+        const float angular_coefficient = fabs(angular);
+
+        const std::complex<float> moment_along_direction = group.moment_x * group.direction_x +
+                                                           group.moment_y * group.direction_y;
+        const std::complex<float> moment_along_radius = group.moment_x * radius_x + group.moment_y * radius_y;
+
+        radial_part += angular_coefficient * group.amplitude - angular_sign * moment_along_direction +
+                       angular_coefficient * moment_along_radius * distance_factor;
+        rotated_moment_x -= angular_coefficient * group.moment_y;
+        rotated_moment_y += angular_coefficient * group.moment_x;
+      }
+
+      const float radial_strength = DISTANT_SCALE * std::imag(harmonic * radial_part);
+      const Vector2 node_field_strength(
+          -radius_y * radial_strength - DISTANT_SCALE * std::imag(harmonic * rotated_moment_x),
+          radius_x * radial_strength - DISTANT_SCALE * std::imag(harmonic * rotated_moment_y));
+
+      #ifdef VERIFY_DIPOLE_TREE
+      const Vector2 exact_field_strength = dipoles_.GetFieldStrength(point, t, node.first, node.last);
+      float amplitudes_sum = 0.;
+      for (size_t ind = node.first; ind < node.last; ind++)
+      {
+        amplitudes_sum += fabs(dipoles_.GetAmplitude(ind));
+      }
+      const float scale = amplitudes_sum * DISTANT_SCALE / (distance - node.radius);
+      if ((exact_field_strength - node_field_strength).Len( ) > tolerance * scale)
+      {
+        std::cout << "DipoleTree::GetFieldStrength( ): node " << node.first << " - " << node.last << " in " << point <<
+                     ": " << node_field_strength << ", exact: " << exact_field_strength << std::endl;
+      }
+      #endif /* VERIFY_DIPOLE_TREE */
+
+      result += node_field_strength;
+    }
+    else if (node.children_number == 0)
+    {
+      result += dipoles_.GetFieldStrength(point, t, node.first, node.last);
+    }
+    else
+    {
+      for (size_t child_ind = 0; child_ind < node.children_number; child_ind++)
+      {
+        stack[stack_size++] = node.first_child + child_ind;
+      }
+    }
+  }
+
+  return result;
+}
+
+bool DipoleTree::Dump(void) const
+{
+  std::cout << "DipoleTree: " << dipoles_.Size( ) << " dipoles, " << nodes_.size( ) << " nodes, " <<
+               groups_.size( ) << " direction groups, valid: " << is_valid_ << std::endl;
+  if (!nodes_.empty( ))
+  {
+    std::cout << "\troot center: " << nodes_[0].center_x << " " << nodes_[0].center_y << " radius: " <<
+                 nodes_[0].radius << std::endl;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
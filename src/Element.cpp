@@ -11,7 +11,7 @@ Element::Element(const Element & that)
        direction_(that.direction_)  {
 }
 
-Element::Element(Element && that)
+Element::Element(Element && that) noexcept
     :  position_(std::move(that.position_)),
        direction_(std::move(that.direction_))  {
 }
@@ -0,0 +1,172 @@
+#include "FastTrig.h"
+
+#include <assert.h>
+#include <atomic>
+#include <iostream>
+#include <algorithm>
+
+namespace my_math
+{
+
+// Errors are checked on [-TRIG_REPORT_RANGE, TRIG_REPORT_RANGE] with TRIG_REPORT_POINTS points.
+const float TRIG_REPORT_RANGE = 1e4;
+const int TRIG_REPORT_POINTS = 1 << 22;
+
+namespace
+{
+
+// Pool threads read it while main thread can set it.
+std::atomic<int> trig_accuracy(DEFAULT_TRIG_ACCURACY);
+
+struct TrigErrors
+{
+  double sin_error;
+  double cos_error;
+};
+
+void AddErrors(const float x, const float sin_x, const float cos_x, TrigErrors *errors)
+{
+  errors -> sin_error = std::max(errors -> sin_error, fabs(sin_x - sin(static_cast<double>(x))));
+  errors -> cos_error = std::max(errors -> cos_error, fabs(cos_x - cos(static_cast<double>(x))));
+  return;
+}
+
+float GetReportPoint(const int ind)
+{
+  return -TRIG_REPORT_RANGE + 2 * TRIG_REPORT_RANGE * ind / TRIG_REPORT_POINTS;
+}
+
+template <TRIG_ACCURACIES accuracy>
+TrigErrors GetScalarErrors(void)
+{
+  TrigErrors errors = {0., 0.};
+  for (int ind = 0; ind < TRIG_REPORT_POINTS; ind++)
+  {
+    const float x = GetReportPoint(ind);
+    float sin_x = 0.;
+    float cos_x = 0.;
+    SinCosPolynomial<accuracy>(x, &sin_x, &cos_x);
+    AddErrors(x, sin_x, cos_x, &errors);
+  }
+  return errors;
+}
+
+TrigErrors GetReferenceErrors(void)
+{
+  TrigErrors errors = {0., 0.};
+  for (int ind = 0; ind < TRIG_REPORT_POINTS; ind++)
+  {
+    const float x = GetReportPoint(ind);
+    AddErrors(x, sin(static_cast<double>(x)), cos(static_cast<double>(x)), &errors);
+  }
+  return errors;
+}
+
+
+#ifdef FAST_TRIG_X86
+
+template <TRIG_ACCURACIES accuracy>
+TrigErrors GetSse2Errors(void)
+{
+  TrigErrors errors = {0., 0.};
+  for (int ind = 0; ind < TRIG_REPORT_POINTS; ind += 4)
+  {
+    float x[4];
+    float sin_x[4];
+    float cos_x[4];
+    for (int lane = 0; lane < 4; lane++)
+    {
+      x[lane] = GetReportPoint(ind + lane);
+    }
+
+    __m128 sin_lanes;
+    __m128 cos_lanes;
+    SinCosSse2<accuracy>(_mm_loadu_ps(x), &sin_lanes, &cos_lanes);
+    _mm_storeu_ps(sin_x, sin_lanes);
+    _mm_storeu_ps(cos_x, cos_lanes);
+
+    for (int lane = 0; lane < 4; lane++)
+    {
+      AddErrors(x[lane], sin_x[lane], cos_x[lane], &errors);
+    }
+  }
+  return errors;
+}
+
+template <TRIG_ACCURACIES accuracy>
+__attribute__((target("avx2,fma"))) TrigErrors GetAvx2Errors(void)
+{
+  TrigErrors errors = {0., 0.};
+  for (int ind = 0; ind < TRIG_REPORT_POINTS; ind += 8)
+  {
+    float x[8];
+    float sin_x[8];
+    float cos_x[8];
+    for (int lane = 0; lane < 8; lane++)
+    {
+      x[lane] = GetReportPoint(ind + lane);
+    }
+
+    __m256 sin_lanes;
+    __m256 cos_lanes;
+    SinCosAvx2<accuracy>(_mm256_loadu_ps(x), &sin_lanes, &cos_lanes);
+    _mm256_storeu_ps(sin_x, sin_lanes);
+    _mm256_storeu_ps(cos_x, cos_lanes);
+
+    for (int lane = 0; lane < 8; lane++)
+    {
+      AddErrors(x[lane], sin_x[lane], cos_x[lane], &errors);
+    }
+  }
+  return errors;
+}
+
+#endif /* FAST_TRIG_X86 */
+
+
+void PrintErrors(const char *name, const TrigErrors & errors)
+{
+  std::cout << "\t" << name << ": sin " << errors.sin_error << ", cos " << errors.cos_error << std::endl;
+  return;
+}
+
+} // End of anonymous namespace.
+
+
+void SetTrigAccuracy(const TRIG_ACCURACIES accuracy)
+{
+  assert(accuracy >= FAST_TRIG && accuracy < TRIG_ACCURACIES_NUMBER);
+  trig_accuracy.store(accuracy, std::memory_order_relaxed);
+  return;
+}
+
+TRIG_ACCURACIES GetTrigAccuracy(void)
+{
+  return static_cast<TRIG_ACCURACIES>(trig_accuracy.load(std::memory_order_relaxed));
+}
+
+bool ReportTrigErrors(void)
+{
+  std::cout << "Maximal errors against libm on [" << -TRIG_REPORT_RANGE << ", " << TRIG_REPORT_RANGE << "]:" <<
+               std::endl;
+
+  PrintErrors("fast scalar", GetScalarErrors<FAST_TRIG>( ));
+  PrintErrors("approximate scalar", GetScalarErrors<APPROXIMATE_TRIG>( ));
+  PrintErrors("reference", GetReferenceErrors( ));
+
+  #ifdef FAST_TRIG_X86
+  PrintErrors("fast SSE2", GetSse2Errors<FAST_TRIG>( ));
+  PrintErrors("approximate SSE2", GetSse2Errors<APPROXIMATE_TRIG>( ));
+
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+  {
+    PrintErrors("fast AVX2", GetAvx2Errors<FAST_TRIG>( ));
+    PrintErrors("approximate AVX2", GetAvx2Errors<APPROXIMATE_TRIG>( ));
+  }
+  #endif /* FAST_TRIG_X86 */
+
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
@@ -0,0 +1,75 @@
+#include "FrontBuffer.h"
+
+#include "FrontElement.h"
+
+namespace my_math
+{
+
+// Front element is square with side of circle's diameter.
+const size_t FRONT_ELEMENT_VERTICES = 4;
+const float FRONT_ELEMENT_SIDE = 2 * DEFAULT_FRONT_ELEMENT_RADIUS;
+
+FrontBuffer::FrontBuffer(void)
+    :  vertices_(sf::Quads)  {
+}
+
+void FrontBuffer::Clear(void)
+{
+  positions_.clear( );
+  strengths_.clear( );
+  return;
+}
+
+void FrontBuffer::Push(const Vector2 & position, const float strength)
+{
+  positions_.push_back(position);
+  strengths_.push_back(strength);
+  return;
+}
+
+void FrontBuffer::Append(const FrontBuffer & that)
+{
+  positions_.insert(positions_.end( ), that.positions_.begin( ), that.positions_.end( ));
+  strengths_.insert(strengths_.end( ), that.strengths_.begin( ), that.strengths_.end( ));
+  return;
+}
+
+size_t FrontBuffer::Size(void) const
+{
+  return positions_.size( );
+}
+
+bool FrontBuffer::Draw(sf::RenderWindow & window)
+{
+  #ifdef FRONT_BUFFER_DEBUG
+  Dump( );
+  #endif /* FRONT_BUFFER_DEBUG */
+
+  vertices_.resize(positions_.size( ) * FRONT_ELEMENT_VERTICES);
+
+  // Position is the top left corner as position of sf::CircleShape.
+  for (size_t ind = 0; ind < positions_.size( ); ind++)
+  {
+    const float x = positions_[ind].GetX( );
+    const float y = positions_[ind].GetY( );
+    const sf::Color color = FrontElement::GetStrengthColor(strengths_[ind]);
+
+    sf::Vertex *quad = &vertices_[ind * FRONT_ELEMENT_VERTICES];
+    quad[0] = sf::Vertex(sf::Vector2f(x, y), color);
+    quad[1] = sf::Vertex(sf::Vector2f(x + FRONT_ELEMENT_SIDE, y), color);
+    quad[2] = sf::Vertex(sf::Vector2f(x + FRONT_ELEMENT_SIDE, y + FRONT_ELEMENT_SIDE), color);
+    quad[3] = sf::Vertex(sf::Vector2f(x, y + FRONT_ELEMENT_SIDE), color);
+  }
+
+  window.draw(vertices_);
+  return true;
+}
+
+bool FrontBuffer::Dump(void) const
+{
+  std::cout << "FrontBuffer: " << positions_.size( ) << " front elements" << std::endl;
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
@@ -4,49 +4,32 @@ namespace my_math
 {
 
 FrontElement::FrontElement()
-{
-
+    :  amplitude_(0)  {
 }
 
 
 FrontElement::FrontElement(const Vector2 & position)
-    :  Element(position)
-{
-  circle_shape_ = sf::CircleShape(DEFAULT_FRONT_ELEMENT_RADIUS, DEFAULT_FRONT_ELEMENT_PCOUNT);
-  circle_shape_.setFillColor(sf::Color(255, 0, 0, 255));
+    :  Element(position),
+       amplitude_(0)  {
 }
 
 
 FrontElement::FrontElement(const FrontElement &that)
     :  Element(that),
-       amplitude_(that.amplitude_),
-       circle_shape_(that.circle_shape_)  {
+       amplitude_(that.amplitude_)  {
 }
 
 
-FrontElement::FrontElement(FrontElement &&that)
-    :  Element(that),
-       amplitude_(std::move(that.amplitude_)),
-       circle_shape_(std::move(that.circle_shape_))  {
+FrontElement::FrontElement(FrontElement &&that) noexcept
+    :  Element(std::move(that)),
+       amplitude_(std::move(that.amplitude_))  {
 }
 
-void FrontElement::Swap(FrontElement & that)
+void FrontElement::Swap(FrontElement & that) noexcept
 {
-  float tmp_amplitude = amplitude_;
-  amplitude_ = that.amplitude_;
-  that.amplitude_ = amplitude_;
-
-  sf::CircleShape tmp_circle_shape = that.circle_shape_;
-  circle_shape_ = that.circle_shape_;
-  that.circle_shape_ = circle_shape_;
-
-  Vector2 tmp_position = that.position_;
-  that.position_ = position_;
-  position_ = tmp_position;
-
-  float tmp_direction = that.direction_;
-  that.direction_ = direction_;
-  direction_ = tmp_direction;
+  std::swap(amplitude_, that.amplitude_);
+  std::swap(position_, that.position_);
+  std::swap(direction_, that.direction_);
   return;
 }
 
@@ -62,7 +45,7 @@ FrontElement& FrontElement::operator=(const FrontElement &that)
 }
 
 
-FrontElement& FrontElement::operator=(FrontElement &&that)
+FrontElement& FrontElement::operator=(FrontElement &&that) noexcept
 {
   Swap(that);
   return *this;
@@ -73,23 +56,19 @@ FrontElement::~FrontElement()
 
 }
 
-bool FrontElement::SetRGBA(int R, int G, int B, int A)
-{
-  circle_shape_.setFillColor(sf::Color(R, G, B, A));
-}
-
 bool FrontElement::Draw(sf::RenderWindow & window)
 {
-  circle_shape_.setPosition(position_.GetX( ), position_.GetY( ));
-  window.draw(circle_shape_);
+  // The only shape of all front elements. It is used only by the drawing thread.
+  static sf::CircleShape circle_shape(DEFAULT_FRONT_ELEMENT_RADIUS, DEFAULT_FRONT_ELEMENT_PCOUNT);
+  circle_shape.setFillColor(sf::Color(255, 0, 0, 255));
+  circle_shape.setPosition(position_.GetX( ), position_.GetY( ));
+  window.draw(circle_shape);
 
   return true;
 }
 
-bool FrontElement::DrawColor(sf::RenderWindow & window, float strength)
+sf::Color FrontElement::GetStrengthColor(const float strength)
 {
-  circle_shape_.setPosition(position_.GetX( ), position_.GetY( ));
-
   static float upper_bound = 10;
   float rate = strength;
   /*
@@ -101,15 +80,12 @@ bool FrontElement::DrawColor(sf::RenderWindow & window, float strength)
     upper_bound = rate;
 
   #ifdef FRONT_ELEMENT_DEBUG
-  //std::cout << "FrontElement::DrawColor(). strength: " << strength << " upper_bound: " << upper_bound << std::endl;
-  std::cout << "FrontElement::DrawColor(). strength: " << strength << " rate " << rate << " upper_bound: " << upper_bound << std::endl;
+  //std::cout << "FrontElement::GetStrengthColor(). strength: " << strength << " upper_bound: " << upper_bound << std::endl;
+  std::cout << "FrontElement::GetStrengthColor(). strength: " << strength << " rate " << rate << " upper_bound: " << upper_bound << std::endl;
   #endif /* FRONT_ELEMENT_DEBUG */
 
-  //SetRGBA(255, 0, 0, (int)((strength / upper_bound) * 255));
-  SetRGBA(255, 0, 0, (int)((rate / upper_bound) * 255));
-  window.draw(circle_shape_);
-
-  return true;
+  //return sf::Color(255, 0, 0, (int)((strength / upper_bound) * 255));
+  return sf::Color(255, 0, 0, (int)((rate / upper_bound) * 255));
 }
 
 bool FrontElement::Dump() const
@@ -0,0 +1,138 @@
+#include "GratingGrid.h"
+
+namespace my_math
+{
+
+GratingGrid::GratingGrid(void)
+    :  left_(0),
+       top_(0),
+       columns_(0),
+       rows_(0)  {
+}
+
+void GratingGrid::Build(const SlotMap<DiffractionGrating> & diffraction_gratings)
+{
+  Clear( );
+  if (diffraction_gratings.Empty( ))
+  {
+    return;
+  }
+
+  // Box of all gratings.
+  VECTOR_TYPE left = diffraction_gratings[0].Left( );
+  VECTOR_TYPE right = diffraction_gratings[0].Right( );
+  VECTOR_TYPE top = diffraction_gratings[0].Top( );
+  VECTOR_TYPE bottom = diffraction_gratings[0].Bottom( );
+  for (const DiffractionGrating & diffraction_grating : diffraction_gratings)
+  {
+    left = std::min(left, diffraction_grating.Left( ));
+    right = std::max(right, diffraction_grating.Right( ));
+    top = std::min(top, diffraction_grating.Top( ));
+    bottom = std::max(bottom, diffraction_grating.Bottom( ));
+  }
+
+  left_ = left;
+  top_ = top;
+  columns_ = static_cast<int>((right - left) / GRATING_GRID_STEP) + 1;
+  rows_ = static_cast<int>((bottom - top) / GRATING_GRID_STEP) + 1;
+
+  // Indices are counted by cells, then placed. Gratings are placed in order, so indices of cell are increasing.
+  cell_starts_.assign(columns_ * rows_ + 1, 0);
+  for (const DiffractionGrating & diffraction_grating : diffraction_gratings)
+  {
+    int first_column = 0, last_column = 0, first_row = 0, last_row = 0;
+    if (!GetCells(diffraction_grating.Left( ), diffraction_grating.Right( ), diffraction_grating.Top( ),
+                  diffraction_grating.Bottom( ), &first_column, &last_column, &first_row, &last_row))
+    {
+      continue;
+    }
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+      for (int column = first_column; column <= last_column; column++)
+      {
+        cell_starts_[row * columns_ + column + 1]++;
+      }
+    }
+  }
+
+  for (size_t ind = 1; ind < cell_starts_.size( ); ind++)
+  {
+    cell_starts_[ind] += cell_starts_[ind - 1];
+  }
+
+  grating_indices_.resize(cell_starts_.back( ));
+  std::vector<int> cell_ends(cell_starts_.begin( ), cell_starts_.end( ) - 1);
+  for (int grating_ind = 0; grating_ind < static_cast<int>(diffraction_gratings.Size( )); grating_ind++)
+  {
+    const DiffractionGrating & diffraction_grating = diffraction_gratings[grating_ind];
+    int first_column = 0, last_column = 0, first_row = 0, last_row = 0;
+    if (!GetCells(diffraction_grating.Left( ), diffraction_grating.Right( ), diffraction_grating.Top( ),
+                  diffraction_grating.Bottom( ), &first_column, &last_column, &first_row, &last_row))
+    {
+      continue;
+    }
+
+    for (int row = first_row; row <= last_row; row++)
+    {
+      for (int column = first_column; column <= last_column; column++)
+      {
+        grating_indices_[cell_ends[row * columns_ + column]++] = grating_ind;
+      }
+    }
+  }
+
+  #ifdef GRATING_GRID_DEBUG
+  Dump( );
+  #endif /* GRATING_GRID_DEBUG */
+
+  return;
+}
+
+void GratingGrid::Clear(void)
+{
+  columns_ = 0;
+  rows_ = 0;
+  cell_starts_.clear( );
+  grating_indices_.clear( );
+  return;
+}
+
+bool GratingGrid::GetCells(const VECTOR_TYPE left, const VECTOR_TYPE right, const VECTOR_TYPE top,
+                           const VECTOR_TYPE bottom, int *first_column, int *last_column, int *first_row,
+                           int *last_row) const
+{
+  assert(first_column != nullptr);
+  assert(last_column != nullptr);
+  assert(first_row != nullptr);
+  assert(last_row != nullptr);
+
+  const VECTOR_TYPE first_x = (left - left_) / GRATING_GRID_STEP;
+  const VECTOR_TYPE last_x = (right - left_) / GRATING_GRID_STEP;
+  const VECTOR_TYPE first_y = (top - top_) / GRATING_GRID_STEP;
+  const VECTOR_TYPE last_y = (bottom - top_) / GRATING_GRID_STEP;
+
+  // Comparisons are false for NaN too.
+  if (!(last_x >= 0 && first_x < columns_ && last_y >= 0 && first_y < rows_ && first_x <= last_x &&
+        first_y <= last_y))
+  {
+    return false;
+  }
+
+  // Range is clamped before conversion, so far ends of long segments don't overflow.
+  *first_column = static_cast<int>(std::max(first_x, static_cast<VECTOR_TYPE>(0)));
+  *last_column = static_cast<int>(std::min(last_x, static_cast<VECTOR_TYPE>(columns_ - 1)));
+  *first_row = static_cast<int>(std::max(first_y, static_cast<VECTOR_TYPE>(0)));
+  *last_row = static_cast<int>(std::min(last_y, static_cast<VECTOR_TYPE>(rows_ - 1)));
+  return true;
+}
+
+bool GratingGrid::Dump(void) const
+{
+  std::cout << "GratingGrid: " << columns_ << " x " << rows_ << " cells, " << grating_indices_.size( ) <<
+               " indices" << std::endl;
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
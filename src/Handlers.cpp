@@ -1,5 +1,6 @@
 #include "Handlers.h"
 #include "Element.h"
+#include "FastTrig.h"
 
 namespace handler {
 
@@ -126,7 +127,7 @@ bool HandleMouse(const sf::RenderWindow &window, const sf::Event &event, Store &
 
       if (IsFrontArea(position)) {
         singular_wave.Push(FrontElement(position));
-        store.Push(singular_wave);
+        store.Push(std::move(singular_wave));
       }
 
       break;
@@ -151,6 +152,34 @@ bool HandleKey(const sf::RenderWindow &window, const sf::Event &event, Store & s
       store.Clear();
       break;
 
+    // Remove the last dipole.
+    case sf::Keyboard::BackSpace:
+      #ifdef KEY_DEBUG
+      std::cout << "HandleKey( ): BackSpace" << std::endl;
+      #endif /* KEY_DEBUG */
+      if (store.GetDipolesNumber( ) > 0)
+      {
+        store.RemoveDipole(store.GetDipolesNumber( ) - 1);
+      }
+      break;
+
+    // Switch accuracy of sin and cos: fast, approximate, reference.
+    case sf::Keyboard::A:
+      #ifdef KEY_DEBUG
+      std::cout << "HandleKey( ): A" << std::endl;
+      #endif /* KEY_DEBUG */
+      my_math::SetTrigAccuracy(static_cast<my_math::TRIG_ACCURACIES>((my_math::GetTrigAccuracy( ) + 1) %
+                                                                     my_math::TRIG_ACCURACIES_NUMBER));
+      break;
+
+    // Switch drawing of fronts: traced or extracted as iso-lines.
+    case sf::Keyboard::F:
+      #ifdef KEY_DEBUG
+      std::cout << "HandleKey( ): F" << std::endl;
+      #endif /* KEY_DEBUG */
+      store.SetContourFronts(!store.IsContourFronts( ));
+      break;
+
     // Set phases.
     case sf::Keyboard::Num1:
       #ifdef KEY_DEBUG
@@ -351,7 +380,7 @@ bool HandleKey(const sf::RenderWindow &window, const sf::Event &event, Store & s
       #endif /* KEY_DEBUG */
       {
         DiffractionGrating diffraction_grating = DiffractionGrating(my_math::Vector2(position), 180., SMALL_HANDLE_LENGTH, 8);
-        store.Push(diffraction_grating);
+        store.Push(std::move(diffraction_grating));
       }
       break; /* KEY DEBAG*/
 
@@ -362,7 +391,7 @@ bool HandleKey(const sf::RenderWindow &window, const sf::Event &event, Store & s
 
       {
         DiffractionGrating diffraction_grating = DiffractionGrating(my_math::Vector2(position), 340., STANDART_HANDLE_LENGTH, 4);
-        store.Push(diffraction_grating);
+        store.Push(std::move(diffraction_grating));
       }
       break; /* KEY DEBAG*/
 
@@ -372,7 +401,7 @@ bool HandleKey(const sf::RenderWindow &window, const sf::Event &event, Store & s
       #endif 
       {
         DiffractionGrating diffraction_grating3 = DiffractionGrating(my_math::Vector2(position), 400., STANDART_HANDLE_LENGTH, 2);
-        store.Push(diffraction_grating3);
+        store.Push(std::move(diffraction_grating3));
       }
       break; /* KEY DEBAG*/
 
@@ -383,7 +412,7 @@ bool HandleKey(const sf::RenderWindow &window, const sf::Event &event, Store & s
       {
         DiffractionGrating diffraction_grating4 = DiffractionGrating(my_math::Vector2(position), 500.,
                                                                      STANDART_HANDLE_LENGTH, 1);
-        store.Push(diffraction_grating4);
+        store.Push(std::move(diffraction_grating4));
       }
       break;
   }
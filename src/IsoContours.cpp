@@ -0,0 +1,278 @@
+#include "IsoContours.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace my_math
+{
+
+IsoContours::IsoContours(void)
+    :  columns_(SCREEN_WIDTH / ISO_CONTOURS_STEP + 1),
+       rows_(SCREEN_HEIGHT / ISO_CONTOURS_STEP + 1),
+       is_valid_(false),
+       updates_number_(0),
+       in_phase_parts_(columns_ * rows_),
+       quadrature_parts_(columns_ * rows_),
+       values_(columns_ * rows_)  {
+}
+
+void IsoContours::Build(const DipolePack & dipoles, ThreadPool & thread_pool)
+{
+  std::fill(in_phase_parts_.begin( ), in_phase_parts_.end( ), 0.);
+  std::fill(quadrature_parts_.begin( ), quadrature_parts_.end( ), 0.);
+  AddToNodes(dipoles, 0, dipoles.Size( ), 1., thread_pool);
+
+  is_valid_ = true;
+  updates_number_ = 0;
+
+  #ifdef ISO_CONTOURS_DEBUG
+  Dump( );
+  #endif /* ISO_CONTOURS_DEBUG */
+
+  return;
+}
+
+void IsoContours::Update(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+                         ThreadPool & thread_pool)
+{
+  assert(is_valid_);
+
+  AddToNodes(dipoles, first, last, sign, thread_pool);
+
+  updates_number_++;
+  if (updates_number_ >= ISO_CONTOURS_MAX_UPDATES)
+  {
+    Invalidate( );
+  }
+
+  #ifdef ISO_CONTOURS_DEBUG
+  std::cout << "IsoContours::Update( ): dipoles " << first << " - " << last << " sign " << sign << std::endl;
+  #endif /* ISO_CONTOURS_DEBUG */
+
+  return;
+}
+
+void IsoContours::AddToNodes(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+                             ThreadPool & thread_pool)
+{
+  if (first == last)
+  {
+    return;
+  }
+
+  // Every row is one batch of points.
+  thread_pool.ParallelFor(rows_, 1, [&](const size_t begin, const size_t end) {
+    std::vector<Vector2> positions(columns_);
+    std::vector<float> in_phase_parts(columns_);
+    std::vector<float> quadrature_parts(columns_);
+
+    for (size_t row = begin; row < end; row++)
+    {
+      for (size_t column = 0; column < columns_; column++)
+      {
+        positions[column] = Vector2(column * ISO_CONTOURS_STEP, row * ISO_CONTOURS_STEP);
+      }
+
+      dipoles.GetFrontPhasors(positions.data( ), in_phase_parts.data( ), quadrature_parts.data( ), columns_, first,
+                              last);
+
+      for (size_t column = 0; column < columns_; column++)
+      {
+        in_phase_parts_[row * columns_ + column] += sign * in_phase_parts[column];
+        quadrature_parts_[row * columns_ + column] += sign * quadrature_parts[column];
+      }
+    }
+  });
+
+  return;
+}
+
+void IsoContours::Invalidate(void)
+{
+  is_valid_ = false;
+  return;
+}
+
+bool IsoContours::IsValid(void) const
+{
+  return is_valid_;
+}
+
+void IsoContours::Extract(const DipolePack & dipoles, const float t, const Vector2 *positions,
+                          const size_t positions_number, ThreadPool & thread_pool, FrontBuffer *front_buffer)
+{
+  assert(is_valid_);
+  assert(positions != nullptr || positions_number == 0);
+  assert(front_buffer != nullptr);
+
+  const float time_phase = GetTimePhase(t);
+  const float time_cos = cos(time_phase);
+  const float time_sin = sin(time_phase);
+
+  // Level of every front is front function in its position. Fronts on the same level are extracted once.
+  std::vector<float> in_phase_levels(positions_number);
+  std::vector<float> quadrature_levels(positions_number);
+  dipoles.GetFrontPhasors(positions, in_phase_levels.data( ), quadrature_levels.data( ), positions_number, 0,
+                          dipoles.Size( ));
+
+  levels_.resize(positions_number);
+  for (size_t ind = 0; ind < positions_number; ind++)
+  {
+    levels_[ind] = in_phase_levels[ind] * time_cos + quadrature_levels[ind] * time_sin;
+  }
+  std::sort(levels_.begin( ), levels_.end( ));
+  levels_.erase(std::unique(levels_.begin( ), levels_.end( )), levels_.end( ));
+
+  if (levels_.empty( ))
+  {
+    return;
+  }
+
+  thread_pool.ParallelFor(values_.size( ), columns_, [&](const size_t begin, const size_t end) {
+    for (size_t ind = begin; ind < end; ind++)
+    {
+      values_[ind] = in_phase_parts_[ind] * time_cos + quadrature_parts_[ind] * time_sin;
+    }
+  });
+
+  const size_t tile_columns = (columns_ - 1 + ISO_CONTOURS_TILE - 1) / ISO_CONTOURS_TILE;
+  const size_t tile_rows = (rows_ - 1 + ISO_CONTOURS_TILE - 1) / ISO_CONTOURS_TILE;
+  tile_buffers_.resize(tile_columns * tile_rows);
+
+  // Every tile writes only its own buffer.
+  thread_pool.ParallelFor(tile_buffers_.size( ), 1, [&](const size_t begin, const size_t end) {
+    for (size_t tile = begin; tile < end; tile++)
+    {
+      tile_buffers_[tile].Clear( );
+      ExtractTile(tile % tile_columns, tile / tile_columns, &tile_buffers_[tile]);
+    }
+  });
+
+  // Tiles are added in order, so result doesn't depend on threads.
+  for (const FrontBuffer & tile_buffer : tile_buffers_)
+  {
+    front_buffer -> Append(tile_buffer);
+  }
+
+  #ifdef ISO_CONTOURS_DEBUG
+  Dump( );
+  #endif /* ISO_CONTOURS_DEBUG */
+
+  return;
+}
+
+void IsoContours::ExtractTile(const size_t tile_column, const size_t tile_row, FrontBuffer *front_buffer) const
+{
+  const size_t first_column = tile_column * ISO_CONTOURS_TILE;
+  const size_t last_column = std::min(first_column + ISO_CONTOURS_TILE, columns_ - 1);
+  const size_t first_row = tile_row * ISO_CONTOURS_TILE;
+  const size_t last_row = std::min(first_row + ISO_CONTOURS_TILE, rows_ - 1);
+
+  for (size_t row = first_row; row < last_row; row++)
+  {
+    for (size_t column = first_column; column < last_column; column++)
+    {
+      // Front elements aren't drawn over dipole area. Look at FrontElement::IsOnScreen( ).
+      if (column * ISO_CONTOURS_STEP < DEFAULT_AREA_RADIUS)
+      {
+        continue;
+      }
+
+      ExtractCell(column, row, front_buffer);
+    }
+  }
+
+  return;
+}
+
+void IsoContours::ExtractCell(const size_t column, const size_t row, FrontBuffer *front_buffer) const
+{
+  // Corners are counterclockwise on screen: edge ind is between corners ind and (ind + 1) % 4.
+  const size_t ind = row * columns_ + column;
+  const float values[4] = {values_[ind], values_[ind + 1], values_[ind + columns_ + 1], values_[ind + columns_]};
+  const Vector2 corners[4] = {Vector2(column * ISO_CONTOURS_STEP, row * ISO_CONTOURS_STEP),
+                              Vector2((column + 1) * ISO_CONTOURS_STEP, row * ISO_CONTOURS_STEP),
+                              Vector2((column + 1) * ISO_CONTOURS_STEP, (row + 1) * ISO_CONTOURS_STEP),
+                              Vector2(column * ISO_CONTOURS_STEP, (row + 1) * ISO_CONTOURS_STEP)};
+
+  const float low = std::min(std::min(values[0], values[1]), std::min(values[2], values[3]));
+  const float high = std::max(std::max(values[0], values[1]), std::max(values[2], values[3]));
+  if (!std::isfinite(low) || !std::isfinite(high))
+  {
+    return;
+  }
+
+  // Gradient of front function in the middle of cell. Rotated by 90 it is field strength.
+  const float gradient_x = (values[1] - values[0] + values[2] - values[3]) / (2 * ISO_CONTOURS_STEP);
+  const float gradient_y = (values[3] - values[0] + values[2] - values[1]) / (2 * ISO_CONTOURS_STEP);
+  const float strength = sqrt(gradient_x * gradient_x + gradient_y * gradient_y);
+
+  for (auto level = std::upper_bound(levels_.begin( ), levels_.end( ), low);
+       level != levels_.end( ) && *level < high; ++level)
+  {
+    Vector2 crossings[4];
+    size_t crossed_edges[4];
+    size_t crossings_number = 0;
+
+    for (size_t edge = 0; edge < 4; edge++)
+    {
+      const size_t next = (edge + 1) % 4;
+      if ((values[edge] > *level) != (values[next] > *level))
+      {
+        const float part = (*level - values[edge]) / (values[next] - values[edge]);
+        crossings[edge] = corners[edge] + (corners[next] - corners[edge]) * part;
+        crossed_edges[crossings_number] = edge;
+        crossings_number++;
+      }
+    }
+
+    if (crossings_number == 2)
+    {
+      PushSegment(crossings[crossed_edges[0]], crossings[crossed_edges[1]], strength, front_buffer);
+    }
+    else if (crossings_number == 4)
+    {
+      // Saddle: corners on the side of the middle of cell are connected.
+      const bool is_middle_above = (values[0] + values[1] + values[2] + values[3]) / 4 > *level;
+      if (is_middle_above == (values[0] > *level))
+      {
+        PushSegment(crossings[0], crossings[1], strength, front_buffer);
+        PushSegment(crossings[2], crossings[3], strength, front_buffer);
+      }
+      else
+      {
+        PushSegment(crossings[3], crossings[0], strength, front_buffer);
+        PushSegment(crossings[1], crossings[2], strength, front_buffer);
+      }
+    }
+  }
+
+  return;
+}
+
+void IsoContours::PushSegment(const Vector2 & begin, const Vector2 & end, const float strength,
+                              FrontBuffer *front_buffer) const
+{
+  const Vector2 segment = end - begin;
+  const int parts_number = ceil(segment.Len( ) / FRONT_ELEMENT_STEP);
+  for (int part = 0; part < parts_number; part++)
+  {
+    front_buffer -> Push(begin + segment * ((part + 0.5) / parts_number), strength);
+  }
+
+  return;
+}
+
+bool IsoContours::Dump(void) const
+{
+  std::cout << "IsoContours: " << columns_ << " x " << rows_ << " nodes, valid: " << is_valid_ << ", levels: " <<
+               levels_.size( ) << std::endl;
+  for (const float level : levels_)
+  {
+    std::cout << "\t" << level << std::endl;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
@@ -0,0 +1,366 @@
+#include "LinearArrays.h"
+#include "FastTrig.h"
+
+namespace my_math
+{
+
+// Array factor is expanded in series if N * delta is less.
+const double ARRAY_FACTOR_SERIES_LIMIT = 1e-3;
+
+// Test arrays of ReportArrayFactorErrors( ) start in (ARRAY_REPORT_X, ARRAY_REPORT_Y).
+const int ARRAY_REPORT_DIPOLES = 16;
+const float ARRAY_REPORT_X = 20.;
+const float ARRAY_REPORT_Y = 100.;
+const float ARRAY_REPORT_STEP = 10.;
+const float ARRAY_REPORT_PHASE_STEP = 30.;
+const int ARRAY_REPORT_DIRECTION_STEP = 15;
+const float ARRAY_REPORT_TOLERANCE = 0.02;
+
+// Points of report are [ARRAY_REPORT_LEFT, ARRAY_REPORT_RIGHT] x [ARRAY_REPORT_TOP, ARRAY_REPORT_BOTTOM] with step
+// ARRAY_REPORT_POINT_STEP at every time of ARRAY_REPORT_TIMES. Large times check reduction of time phase.
+const float ARRAY_REPORT_LEFT = 1470.;
+const float ARRAY_REPORT_RIGHT = 1540.;
+const float ARRAY_REPORT_TOP = 1000.;
+const float ARRAY_REPORT_BOTTOM = 1200.;
+const float ARRAY_REPORT_POINT_STEP = 5.;
+const float ARRAY_REPORT_TIMES[] = {1e-7, 3.3e-6, 17., 93.2};
+
+namespace
+{
+
+inline float WrapPhase(const float phase)
+{
+  return std::remainder(phase, 2 * PI);
+}
+
+inline bool IsEqual(const float first, const float second, const float scale)
+{
+  return fabs(first - second) <= LINEAR_ARRAY_EPSILON * scale;
+}
+
+} // End of anonymous namespace.
+
+LinearArrays::LinearArrays(void)  {
+}
+
+void LinearArrays::Push(const DipolePack & dipoles)
+{
+  assert(dipoles.Size( ) > 0);
+  Add(dipoles, dipoles.Size( ) - 1);
+  return;
+}
+
+void LinearArrays::Build(const DipolePack & dipoles)
+{
+  arrays_.clear( );
+  for (size_t ind = 0; ind < dipoles.Size( ); ind++)
+  {
+    Add(dipoles, ind);
+  }
+
+  #ifdef LINEAR_ARRAYS_DEBUG
+  Dump( );
+  #endif /* LINEAR_ARRAYS_DEBUG */
+
+  return;
+}
+
+void LinearArrays::Clear(void)
+{
+  arrays_.clear( );
+  return;
+}
+
+void LinearArrays::Add(const DipolePack & dipoles, const size_t ind)
+{
+  const Vector2 position = dipoles.GetPosition(ind);
+  const Vector2 direction = dipoles.GetDirectionVector(ind);
+  const float amplitude = dipoles.GetAmplitude(ind);
+  const float phase = dipoles.GetPhase(ind);
+
+  if (!arrays_.empty( ) && arrays_.back( ).last == ind)
+  {
+    LinearArray & last_array = arrays_.back( );
+
+    if (last_array.last - last_array.first == 1)
+    {
+      // The second dipole sets step of array.
+      const bool is_same_kind = IsEqual(direction.GetX( ), last_array.direction_x, 1.) &&
+                                IsEqual(direction.GetY( ), last_array.direction_y, 1.) &&
+                                IsEqual(amplitude, last_array.amplitude, last_array.amplitude);
+      const bool is_shifted = position.GetX( ) != last_array.first_x || position.GetY( ) != last_array.first_y;
+
+      if (is_same_kind && is_shifted)
+      {
+        last_array.step_x = position.GetX( ) - last_array.first_x;
+        last_array.step_y = position.GetY( ) - last_array.first_y;
+        last_array.phase_step = WrapPhase(phase - last_array.first_phase);
+        last_array.last++;
+        return;
+      }
+    }
+    else if (IsContinued(last_array, dipoles, ind))
+    {
+      last_array.last++;
+      return;
+    }
+  }
+
+  arrays_.push_back(LinearArray{ind, ind + 1, position.GetX( ), position.GetY( ), 0., 0., direction.GetX( ),
+                                direction.GetY( ), amplitude, phase, 0.});
+  return;
+}
+
+bool LinearArrays::IsContinued(const LinearArray & linear_array, const DipolePack & dipoles, const size_t ind) const
+{
+  assert(linear_array.last - linear_array.first >= 2);
+
+  const float dipoles_number = linear_array.last - linear_array.first;
+  const float step_length = sqrt(linear_array.step_x * linear_array.step_x +
+                                 linear_array.step_y * linear_array.step_y);
+
+  const Vector2 position = dipoles.GetPosition(ind);
+  const Vector2 direction = dipoles.GetDirectionVector(ind);
+
+  const float expected_phase = linear_array.first_phase + dipoles_number * linear_array.phase_step;
+
+  return IsEqual(position.GetX( ), linear_array.first_x + dipoles_number * linear_array.step_x, step_length) &&
+         IsEqual(position.GetY( ), linear_array.first_y + dipoles_number * linear_array.step_y, step_length) &&
+         IsEqual(direction.GetX( ), linear_array.direction_x, 1.) &&
+         IsEqual(direction.GetY( ), linear_array.direction_y, 1.) &&
+         IsEqual(dipoles.GetAmplitude(ind), linear_array.amplitude, linear_array.amplitude) &&
+         fabs(WrapPhase(dipoles.GetPhase(ind) - expected_phase)) <= LINEAR_ARRAY_PHASE_EPSILON;
+}
+
+bool LinearArrays::HasArrays(void) const
+{
+  for (const LinearArray & linear_array : arrays_)
+  {
+    if (linear_array.last - linear_array.first >= LINEAR_ARRAY_MIN_DIPOLES)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+Vector2 LinearArrays::GetFieldStrength(const DipolePack & dipoles, const Vector2 & point, const float t,
+                                       const float tolerance) const
+{
+  const float time_phase = GetTimePhase(t);
+
+  Vector2 result(0., 0.);
+
+  // Dipoles [exact_first, linear_array.first) aren't summed yet. They are summed by one call of kernel.
+  size_t exact_first = 0;
+
+  for (const LinearArray & linear_array : arrays_)
+  {
+    Vector2 array_field_strength;
+    if (linear_array.last - linear_array.first < LINEAR_ARRAY_MIN_DIPOLES ||
+        !GetArrayFieldStrength(linear_array, point, time_phase, tolerance, &array_field_strength))
+    {
+      continue;
+    }
+
+    #ifdef VERIFY_ARRAY_FACTOR
+    const Vector2 exact_field_strength = dipoles.GetFieldStrength(point, t, linear_array.first, linear_array.last);
+    const float scale = (linear_array.last - linear_array.first) * linear_array.amplitude * DISTANT_SCALE /
+                        (point - Vector2(linear_array.first_x, linear_array.first_y)).Len( );
+    if ((exact_field_strength - array_field_strength).Len( ) > tolerance * scale)
+    {
+      std::cout << "LinearArrays::GetFieldStrength( ): array " << linear_array.first << " - " << linear_array.last <<
+                   " in " << point << ": " << array_field_strength << ", exact: " << exact_field_strength << std::endl;
+    }
+    #endif /* VERIFY_ARRAY_FACTOR */
+
+    if (exact_first < linear_array.first)
+    {
+      result += dipoles.GetFieldStrength(point, t, exact_first, linear_array.first);
+    }
+    result += array_field_strength;
+    exact_first = linear_array.last;
+  }
+
+  if (exact_first < dipoles.Size( ))
+  {
+    result += dipoles.GetFieldStrength(point, t, exact_first, dipoles.Size( ));
+  }
+
+  return result;
+}
+
+bool LinearArrays::GetArrayFieldStrength(const LinearArray & linear_array, const Vector2 & point,
+                                         const float time_phase, const float tolerance,
+                                         Vector2 *field_strength) const
+{
+  assert(field_strength != nullptr);
+
+  const int dipoles_number = linear_array.last - linear_array.first;
+  const float middle = (dipoles_number - 1) / 2.;
+
+  const float step_x = linear_array.step_x;
+  const float step_y = linear_array.step_y;
+  const float half_length = middle * sqrt(step_x * step_x + step_y * step_y);
+
+  const float radius_x = point.GetX( ) - (linear_array.first_x + middle * step_x);
+  const float radius_y = point.GetY( ) - (linear_array.first_y + middle * step_y);
+  const float distance = sqrt(radius_x * radius_x + radius_y * radius_y);
+
+  if (distance <= half_length)
+  {
+    return false;
+  }
+
+  // Look at DipoleTree::GetFieldStrength( ) for the same estimation of error.
+  const float shift_error = half_length * (3 + DISTANCE_PHASE_FACTOR * distance) / (distance - half_length);
+  const float angular = radius_x * linear_array.direction_x + radius_y * linear_array.direction_y;
+  if (shift_error * shift_error > tolerance || fabs(angular) <= half_length)
+  {
+    return false;
+  }
+
+  // Dipole k - middle has phase center_phase + (k - middle) * phase_shift at point.
+  const float inverse_distance = 1. / distance;
+  const float phase_shift = linear_array.phase_step +
+                            DISTANCE_PHASE_FACTOR * (step_x * radius_x + step_y * radius_y) * inverse_distance;
+  const float center_phase = time_phase - DISTANCE_PHASE_FACTOR * distance + linear_array.first_phase +
+                             middle * linear_array.phase_step;
+
+  // array_factor = sum of cos((k - middle) * phase_shift) = sin(N * phase_shift / 2) / sin(phase_shift / 2).
+  // Near multiples of 2 * PI it is expanded in series. It is computed in double because of cancellation.
+  const double turns = std::round(phase_shift / (2 * PI));
+  const double delta = phase_shift - turns * 2 * PI;
+  const double sign = (static_cast<long>(turns) * (dipoles_number - 1)) % 2 == 0 ? 1. : -1.;
+  const double number = dipoles_number;
+
+  double array_factor = 0.;
+  double array_factor_derivative = 0.;
+  if (fabs(number * delta) < ARRAY_FACTOR_SERIES_LIMIT)
+  {
+    array_factor = number - number * (number * number - 1) * delta * delta / 24;
+    array_factor_derivative = -number * (number * number - 1) * delta / 12;
+  }
+  else
+  {
+    const double half_sin = sin(delta / 2);
+    const double half_cos = cos(delta / 2);
+    const double number_sin = sin(number * delta / 2);
+    const double number_cos = cos(number * delta / 2);
+    array_factor = number_sin / half_sin;
+    array_factor_derivative = (number * number_cos * half_sin - number_sin * half_cos) / (2 * half_sin * half_sin);
+  }
+  array_factor *= sign;
+  array_factor_derivative *= sign;
+
+  // Field of dipole k is amplitude * DISTANT_SCALE * radial(radius - (k - middle) * step) * sin(...), where
+  // radial(radius) = rotated_radius * |radius * direction| / distance^3. radial is expanded up to the first order:
+  // radial(radius) - (k - middle) * radial_derivative, and
+  // sum of (k - middle) * sin(center_phase + (k - middle) * phase_shift) = -cos(center_phase) * array_factor'.
+  const float angular_sign = angular > 0 ? 1. : -1.;
+  const float angular_coefficient = fabs(angular);
+  const float inverse_cube = inverse_distance * inverse_distance * inverse_distance;
+  const float step_along_direction = step_x * linear_array.direction_x + step_y * linear_array.direction_y;
+  const float step_along_radius = step_x * radius_x + step_y * radius_y;
+
+  const float radial_x = -radius_y * angular_coefficient * inverse_cube;
+  const float radial_y = radius_x * angular_coefficient * inverse_cube;
+  const float radius_part = (angular_sign * step_along_direction - 3 * angular_coefficient * step_along_radius *
+                             inverse_distance * inverse_distance) * inverse_cube;
+  const float derivative_x = -step_y * angular_coefficient * inverse_cube - radius_y * radius_part;
+  const float derivative_y = step_x * angular_coefficient * inverse_cube + radius_x * radius_part;
+
+  float center_sin = 0.;
+  float center_cos = 0.;
+  FastSinCos(center_phase, &center_sin, &center_cos);
+  const float in_phase_part = center_sin * array_factor;
+  const float derivative_part = center_cos * array_factor_derivative;
+  const float scale = linear_array.amplitude * DISTANT_SCALE;
+
+  *field_strength = Vector2(scale * (radial_x * in_phase_part + derivative_x * derivative_part),
+                            scale * (radial_y * in_phase_part + derivative_y * derivative_part));
+  return true;
+}
+
+bool LinearArrays::Dump(void) const
+{
+  std::cout << "LinearArrays: " << arrays_.size( ) << " runs" << std::endl;
+  for (const LinearArray & linear_array : arrays_)
+  {
+    std::cout << "\tdipoles " << linear_array.first << " - " << linear_array.last << ", step: " <<
+                 linear_array.step_x << " " << linear_array.step_y << ", phase step: " << linear_array.phase_step <<
+                 std::endl;
+  }
+  std::cout << std::endl;
+  return true;
+}
+
+bool ReportArrayFactorErrors(void)
+{
+  // Exact sum is got with libm sin.
+  const TRIG_ACCURACIES trig_accuracy = GetTrigAccuracy( );
+  SetTrigAccuracy(REFERENCE_TRIG);
+
+  float max_error = 0.;
+  Vector2 max_error_point;
+  float max_error_time = 0.;
+  int max_error_direction = 0;
+  size_t failed_number = 0;
+  size_t points_number = 0;
+
+  for (int direction = 0; direction < 360; direction += ARRAY_REPORT_DIRECTION_STEP)
+  {
+    DipolePack dipoles;
+    LinearArrays linear_arrays;
+    for (int ind = 0; ind < ARRAY_REPORT_DIPOLES; ind++)
+    {
+      Dipole dipole(Vector2(ARRAY_REPORT_X, ARRAY_REPORT_Y + ind * ARRAY_REPORT_STEP));
+      dipole.SetDirection(direction);
+      dipole.SetPhase(ind * ARRAY_REPORT_PHASE_STEP);
+      dipoles.Push(dipole);
+      linear_arrays.Push(dipoles);
+    }
+
+    for (const float t : ARRAY_REPORT_TIMES)
+    {
+      for (float x = ARRAY_REPORT_LEFT; x <= ARRAY_REPORT_RIGHT; x += ARRAY_REPORT_POINT_STEP)
+      {
+        for (float y = ARRAY_REPORT_TOP; y <= ARRAY_REPORT_BOTTOM; y += ARRAY_REPORT_POINT_STEP)
+        {
+          const Vector2 point(x, y);
+          Vector2 exact_field_strength(0., 0.);
+          for (size_t ind = 0; ind < dipoles.Size( ); ind++)
+          {
+            exact_field_strength += dipoles.GetFieldStrength(point, t, ind, ind + 1);
+          }
+
+          const Vector2 field_strength = linear_arrays.GetFieldStrength(dipoles, point, t, ARRAY_REPORT_TOLERANCE);
+          const float scale = ARRAY_REPORT_DIPOLES * DEFAULT_AMPLITUDE * DISTANT_SCALE /
+                              (point - Vector2(ARRAY_REPORT_X, ARRAY_REPORT_Y)).Len( );
+          const float error = (field_strength - exact_field_strength).Len( ) / scale;
+
+          points_number++;
+          failed_number += error > ARRAY_REPORT_TOLERANCE;
+          if (error > max_error)
+          {
+            max_error = error;
+            max_error_point = point;
+            max_error_time = t;
+            max_error_direction = direction;
+          }
+        }
+      }
+    }
+  }
+
+  SetTrigAccuracy(trig_accuracy);
+
+  std::cout << "Array factor against exact sum, tolerance " << ARRAY_REPORT_TOLERANCE << ": " << failed_number <<
+               " of " << points_number << " points failed, maximal error " << max_error << " in " << max_error_point <<
+               " at t " << max_error_time << " for direction " << max_error_direction << std::endl;
+  std::cout << std::endl;
+  return failed_number == 0;
+}
+
+} // End of namespace my_math.
@@ -0,0 +1,248 @@
+#include "PhasorGrid.h"
+
+#include <algorithm>
+
+namespace my_math
+{
+
+PhasorGrid::PhasorGrid(void)
+    :  columns_(SCREEN_WIDTH / PHASOR_GRID_STEP + 1),
+       rows_(SCREEN_HEIGHT / PHASOR_GRID_STEP + 1),
+       is_valid_(false),
+       updates_number_(0),
+       nodes_(columns_ * rows_),
+       time_cos_(1.),
+       time_sin_(0.),
+       excluded_distance_(PHASOR_GRID_STEP * std::max(PHASOR_GRID_KINK_FACTOR / DEFAULT_FIELD_TOLERANCE,
+                                                      PHASOR_GRID_CURVATURE_FACTOR / sqrtf(DEFAULT_FIELD_TOLERANCE))),
+       excluded_left_(0.),
+       excluded_right_(0.),
+       excluded_top_(0.),
+       excluded_bottom_(0.)  {
+}
+
+void PhasorGrid::Build(const DipolePack & dipoles, ThreadPool & thread_pool)
+{
+  const size_t dipoles_number = dipoles.Size( );
+
+  // Empty box is far from screen.
+  excluded_left_ = excluded_top_ = DIPOLE_PACK_PADDING_POSITION;
+  excluded_right_ = excluded_bottom_ = -DIPOLE_PACK_PADDING_POSITION;
+  for (size_t ind = 0; ind < dipoles_number; ind++)
+  {
+    ExtendExcludedBox(dipoles.GetPosition(ind));
+  }
+
+  std::fill(nodes_.begin( ), nodes_.end( ), Phasor{0., 0., 0., 0.});
+  AddToNodes(dipoles, 0, dipoles_number, 1., thread_pool);
+
+  is_valid_ = true;
+  updates_number_ = 0;
+
+  #ifdef PHASOR_GRID_DEBUG
+  Dump( );
+  #endif /* PHASOR_GRID_DEBUG */
+
+  return;
+}
+
+void PhasorGrid::Update(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+                        ThreadPool & thread_pool)
+{
+  assert(is_valid_);
+
+  // Box isn't reduced after removing: it is bigger than necessary, but it is still correct.
+  if (sign > 0)
+  {
+    for (size_t ind = first; ind < last; ind++)
+    {
+      ExtendExcludedBox(dipoles.GetPosition(ind));
+    }
+  }
+
+  AddToNodes(dipoles, first, last, sign, thread_pool);
+
+  updates_number_++;
+  if (updates_number_ >= PHASOR_GRID_MAX_UPDATES)
+  {
+    Invalidate( );
+  }
+
+  #ifdef PHASOR_GRID_DEBUG
+  std::cout << "PhasorGrid::Update( ): dipoles " << first << " - " << last << " sign " << sign << std::endl;
+  #endif /* PHASOR_GRID_DEBUG */
+
+  return;
+}
+
+void PhasorGrid::ExtendExcludedBox(const Vector2 & position)
+{
+  excluded_left_ = std::min(excluded_left_, position.GetX( ) - excluded_distance_);
+  excluded_right_ = std::max(excluded_right_, position.GetX( ) + excluded_distance_);
+  excluded_top_ = std::min(excluded_top_, position.GetY( ) - excluded_distance_);
+  excluded_bottom_ = std::max(excluded_bottom_, position.GetY( ) + excluded_distance_);
+  return;
+}
+
+void PhasorGrid::AddToNodes(const DipolePack & dipoles, const size_t first, const size_t last, const float sign,
+                            ThreadPool & thread_pool)
+{
+  if (first == last)
+  {
+    return;
+  }
+
+  // Every row is one batch of points.
+  thread_pool.ParallelFor(rows_, 1, [&](const size_t begin, const size_t end) {
+    std::vector<Vector2> positions(columns_);
+    std::vector<Vector2> in_phase_parts(columns_);
+    std::vector<Vector2> quadrature_parts(columns_);
+
+    for (size_t row = begin; row < end; row++)
+    {
+      for (size_t column = 0; column < columns_; column++)
+      {
+        positions[column] = Vector2(column * PHASOR_GRID_STEP, row * PHASOR_GRID_STEP);
+      }
+
+      dipoles.GetPhasors(positions.data( ), in_phase_parts.data( ), quadrature_parts.data( ), columns_, first, last);
+
+      for (size_t column = 0; column < columns_; column++)
+      {
+        Phasor & node = nodes_[row * columns_ + column];
+        node.in_phase_x += sign * in_phase_parts[column].GetX( );
+        node.in_phase_y += sign * in_phase_parts[column].GetY( );
+        node.quadrature_x += sign * quadrature_parts[column].GetX( );
+        node.quadrature_y += sign * quadrature_parts[column].GetY( );
+      }
+    }
+  });
+
+  return;
+}
+
+void PhasorGrid::SetTolerance(const float tolerance)
+{
+  assert(tolerance > 0.);
+
+  const float excluded_distance = PHASOR_GRID_STEP * std::max(PHASOR_GRID_KINK_FACTOR / tolerance,
+                                                              PHASOR_GRID_CURVATURE_FACTOR / sqrtf(tolerance));
+  if (excluded_distance != excluded_distance_)
+  {
+    excluded_distance_ = excluded_distance;
+    Invalidate( );
+  }
+
+  return;
+}
+
+void PhasorGrid::Invalidate(void)
+{
+  is_valid_ = false;
+  return;
+}
+
+bool PhasorGrid::IsValid(void) const
+{
+  return is_valid_;
+}
+
+void PhasorGrid::SetTime(const float t)
+{
+  const float time_phase = GetTimePhase(t);
+  time_cos_ = cos(time_phase);
+  time_sin_ = sin(time_phase);
+  return;
+}
+
+bool PhasorGrid::Contains(const Vector2 & point) const
+{
+  const float x = point.GetX( );
+  const float y = point.GetY( );
+
+  const bool is_on_grid = x >= 0. && y >= 0. && x <= SCREEN_WIDTH && y <= SCREEN_HEIGHT;
+  const bool is_near_dipoles = x >= excluded_left_ && x <= excluded_right_ && y >= excluded_top_ &&
+                               y <= excluded_bottom_;
+
+  return is_on_grid && !is_near_dipoles;
+}
+
+Vector2 PhasorGrid::GetFieldStrength(const Vector2 & point) const
+{
+  assert(is_valid_);
+
+  const float grid_x = point.GetX( ) / PHASOR_GRID_STEP;
+  const float grid_y = point.GetY( ) / PHASOR_GRID_STEP;
+  const size_t column = std::min(static_cast<size_t>(grid_x), columns_ - 2);
+  const size_t row = std::min(static_cast<size_t>(grid_y), rows_ - 2);
+  const float fraction_x = grid_x - column;
+  const float fraction_y = grid_y - row;
+
+  const Phasor & top_left = nodes_[row * columns_ + column];
+  const Phasor & top_right = nodes_[row * columns_ + column + 1];
+  const Phasor & bottom_left = nodes_[(row + 1) * columns_ + column];
+  const Phasor & bottom_right = nodes_[(row + 1) * columns_ + column + 1];
+
+  const float weight_top_left = (1 - fraction_x) * (1 - fraction_y);
+  const float weight_top_right = fraction_x * (1 - fraction_y);
+  const float weight_bottom_left = (1 - fraction_x) * fraction_y;
+  const float weight_bottom_right = fraction_x * fraction_y;
+
+  const float in_phase_x = weight_top_left * top_left.in_phase_x + weight_top_right * top_right.in_phase_x +
+                           weight_bottom_left * bottom_left.in_phase_x + weight_bottom_right * bottom_right.in_phase_x;
+  const float in_phase_y = weight_top_left * top_left.in_phase_y + weight_top_right * top_right.in_phase_y +
+                           weight_bottom_left * bottom_left.in_phase_y + weight_bottom_right * bottom_right.in_phase_y;
+  const float quadrature_x = weight_top_left * top_left.quadrature_x + weight_top_right * top_right.quadrature_x +
+                             weight_bottom_left * bottom_left.quadrature_x +
+                             weight_bottom_right * bottom_right.quadrature_x;
+  const float quadrature_y = weight_top_left * top_left.quadrature_y + weight_top_right * top_right.quadrature_y +
+                             weight_bottom_left * bottom_left.quadrature_y +
+                             weight_bottom_right * bottom_right.quadrature_y;
+
+  return Vector2(in_phase_x * time_cos_ + quadrature_x * time_sin_, in_phase_y * time_cos_ + quadrature_y * time_sin_);
+}
+
+Vector2 PhasorGrid::GetFieldStrength(const Vector2 & point, FieldJacobian *jacobian) const
+{
+  assert(is_valid_);
+  assert(jacobian != nullptr);
+
+  const float grid_x = point.GetX( ) / PHASOR_GRID_STEP;
+  const float grid_y = point.GetY( ) / PHASOR_GRID_STEP;
+  const size_t column = std::min(static_cast<size_t>(grid_x), columns_ - 2);
+  const size_t row = std::min(static_cast<size_t>(grid_y), rows_ - 2);
+  const float fraction_x = grid_x - column;
+  const float fraction_y = grid_y - row;
+
+  const Vector2 top_left = GetNodeFieldStrength(row * columns_ + column);
+  const Vector2 top_right = GetNodeFieldStrength(row * columns_ + column + 1);
+  const Vector2 bottom_left = GetNodeFieldStrength((row + 1) * columns_ + column);
+  const Vector2 bottom_right = GetNodeFieldStrength((row + 1) * columns_ + column + 1);
+
+  const Vector2 top = top_left + (top_right - top_left) * fraction_x;
+  const Vector2 bottom = bottom_left + (bottom_right - bottom_left) * fraction_x;
+
+  jacobian -> x_derivative = ((top_right - top_left) * (1 - fraction_y) + (bottom_right - bottom_left) * fraction_y) /
+                             PHASOR_GRID_STEP;
+  jacobian -> y_derivative = (bottom - top) / PHASOR_GRID_STEP;
+  return top + (bottom - top) * fraction_y;
+}
+
+Vector2 PhasorGrid::GetNodeFieldStrength(const size_t ind) const
+{
+  const Phasor & node = nodes_[ind];
+  return Vector2(node.in_phase_x * time_cos_ + node.quadrature_x * time_sin_,
+                 node.in_phase_y * time_cos_ + node.quadrature_y * time_sin_);
+}
+
+bool PhasorGrid::Dump(void) const
+{
+  std::cout << "PhasorGrid: " << columns_ << " x " << rows_ << " nodes, valid: " << is_valid_ << std::endl;
+  std::cout << "\texcluded distance: " << excluded_distance_ << std::endl;
+  std::cout << "\texcluded box: " << excluded_left_ << " " << excluded_right_ << " " << excluded_top_ << " " <<
+               excluded_bottom_ << std::endl;
+  std::cout << std::endl;
+  return true;
+}
+
+} // End of namespace my_math.
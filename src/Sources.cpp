@@ -1,4 +1,5 @@
 #include "Sources.h"
+#include "FastTrig.h"
 
 #include <chrono>
 namespace my_math
@@ -43,8 +44,8 @@ Source::Source(const Source & that)
 }
 
 
-Source::Source(Source && that)
-    :  Element(that),
+Source::Source(Source && that) noexcept
+    :  Element(std::move(that)),
        phase_(std::move(that.phase_)),
        amplitude_(std::move(that.amplitude_))  {
 }
@@ -108,12 +109,35 @@ Dipole::Dipole(const Dipole &that)
 }
 
 
-Dipole::Dipole(Dipole &&that)
-    :  Source(that),
+Dipole::Dipole(Dipole &&that) noexcept
+    :  Source(std::move(that)),
        sprite_(std::move(that.sprite_))  {
 }
 
 
+void Dipole::Swap(Dipole & that) noexcept
+{
+  std::swap(sprite_, that.sprite_);
+  std::swap(phase_, that.phase_);
+  std::swap(amplitude_, that.amplitude_);
+  std::swap(position_, that.position_);
+  std::swap(direction_, that.direction_);
+  return;
+}
+
+Dipole & Dipole::operator=(const Dipole & that)
+{
+  Dipole tmp(that);
+  Swap(tmp);
+  return *this;
+}
+
+Dipole & Dipole::operator=(Dipole && that) noexcept
+{
+  Swap(that);
+  return *this;
+}
+
 bool Dipole::Draw(sf::RenderWindow & window) {
   sprite_.setRotation(direction_);
   window.draw(sprite_);
@@ -152,7 +176,7 @@ Vector2 Dipole::GetFieldStrength(const Vector2 & point, const float t) const
 
   // sin(omega*t + k*r + phase)
   // Last version: sin((CYCLIC_FREQUENCY * (t - distance / (DISTANT_SCALE * LIGHT_SPEED)  + phase_) * ONE_RADIAN)
-  float harmonic_part = sin((CYCLIC_FREQUENCY * (t - distance / (DISTANT_SCALE * LIGHT_SPEED * TIME_SCALE))  + phase_) * ONE_RADIAN);
+  float harmonic_part = FastSin((CYCLIC_FREQUENCY * (t - distance / (DISTANT_SCALE * LIGHT_SPEED * TIME_SCALE))  + phase_) * ONE_RADIAN);
 
 
   #ifdef DIPOLE_STRENGTH_DEBUG
@@ -164,7 +188,7 @@ Vector2 Dipole::GetFieldStrength(const Vector2 & point, const float t) const
   #endif /* DIPOLE_STRENGTH_DEBUG */
 
 
-  Vector2 result = radius_vector.GetRotated(90);
+  Vector2 result = radius_vector.GetRotated90( );
   result.Norm();
 
   float field_strength = amplitude_ * angular_coefficient * harmonic_part / (distance / DISTANT_SCALE);
@@ -237,7 +261,8 @@ Dipole::~Dipole()
 
 
 SecondarySource::SecondarySource(void) 
-    :  Source()  {
+    :  Source(),
+       field_strength_(0.)  {
 }
 
 
@@ -248,13 +273,13 @@ SecondarySource::SecondarySource(const SecondarySource & that)
 }
 
 
-SecondarySource::SecondarySource(SecondarySource && that)
-    :  Source(that),
+SecondarySource::SecondarySource(SecondarySource && that) noexcept
+    :  Source(std::move(that)),
        field_strength_(std::move(that.field_strength_)),
        square_(std::move(that.square_))  {
 }
 
-void SecondarySource::Swap(SecondarySource & that)
+void SecondarySource::Swap(SecondarySource & that) noexcept
 {
   std::swap(field_strength_, that.field_strength_);
   std::swap(square_, that.square_);
@@ -273,7 +298,7 @@ SecondarySource & SecondarySource::operator=(const SecondarySource & that)
   return *this;  
 }
 
-SecondarySource& SecondarySource::operator=(SecondarySource && that)
+SecondarySource& SecondarySource::operator=(SecondarySource && that) noexcept
 {
   Swap(that);
   return *this;  
@@ -282,6 +307,7 @@ SecondarySource& SecondarySource::operator=(SecondarySource && that)
 
 SecondarySource::SecondarySource(const Vector2 & position, const float width_secondary_source_area)
     :  Source(position),
+       field_strength_(0.),
        square_(pow(width_secondary_source_area, 2))  {
 }
 
@@ -310,28 +336,35 @@ bool SecondarySource::Dump() const
 }
 
 
-Vector2 SecondarySource::GetFieldStrength(const Vector2 & point, const float t, const std::vector<Dipole> &dipoles_) const
+void SecondarySource::SetBaseFieldStrength(const Vector2 & base_field_strength)
+{
+  field_strength_ = base_field_strength.Len( );
+  return;
+}
+
+
+float SecondarySource::GetRadiationFactor(void) const
+{
+  return square_ * field_strength_ / (2 * WAVE_LENGTH);
+}
+
+
+Vector2 SecondarySource::GetFieldStrength(const Vector2 & point, const float /* t */) const
 {
-  Vector2 base_field_strength = Vector2(0., 0.);
-  for (auto& dipole : dipoles_)
-  {
-    base_field_strength += dipole.GetFieldStrength(position_, t);
-  }
-  
 
   Vector2 relative_position = point - position_;
   float relative_distance = relative_position.Len( );
-  Vector2 direction = relative_position.GetRotated(90.);
+  Vector2 direction = relative_position.GetRotated90( );
   direction.Norm( );
   Vector2 normal_vector = Vector2(1., 0.);
   
   // cos(kr) * (1 + cos(\alpha)).
   float angular_part = (1 + normal_vector.GetCosAngleBetweenVectors(relative_position)) *
-                       cos(WAVE_NUMBER * relative_distance);
+                       FastCos(WAVE_NUMBER * relative_distance);
 
   // S / (2 * \lambda * r). S - square.
-  float other_part =  square_ / (2 * WAVE_LENGTH * relative_distance);
-  Vector2 field_strength = other_part * angular_part * direction * base_field_strength.Len( );
+  float other_part =  GetRadiationFactor( ) / relative_distance;
+  Vector2 field_strength = other_part * angular_part * direction;
 
   #ifdef SECONDARY_SOURCE_STRENGTH_DEBAG
   std::cout << "field strength = " << field_strength << std::endl;
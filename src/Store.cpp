@@ -2,14 +2,18 @@
 
 #include <chrono>
 #include <utility>
-#include <future>
 #include <numeric>
 #include <functional>
-#include <unistd.h>
 
 extern std::chrono::high_resolution_clock::time_point time_start;
 
-Store::Store()
+Store::Store(const unsigned int threads_number, const bool pin_threads)
+    :  phasor_grid_dipoles_number_(0),
+       iso_contours_dipoles_number_(0),
+       is_contour_fronts_(false),
+       field_tolerance_(DEFAULT_FIELD_TOLERANCE),
+       front_tolerance_(DEFAULT_FRONT_TOLERANCE),
+       thread_pool_(threads_number, pin_threads)
 {
   time_from_start = 0.;
 }
@@ -19,280 +23,695 @@ Store::~Store()
 
 }
 
-bool Store::IsCollisions(const Vector2 & position, const DiffractionGrating & diffraction_grating) const
+bool Store::IsCollisions(const Vector2 & begin, const Vector2 & end, const DiffractionGrating & diffraction_grating,
+                         float *part) const
 {
-  VECTOR_TYPE x = position.GetX( );
-  VECTOR_TYPE y = position.GetY( );
-  return x >= diffraction_grating.Left( ) && x <= diffraction_grating.Right( ) + FIXING_MISSING_LENGTH && 
-         y <= diffraction_grating.Bottom( ) && y >= diffraction_grating.Top( );
+  assert(part != nullptr);
+
+  // Segment begin + (end - begin) * part is clipped by slabs of box along x and along y.
+  const VECTOR_TYPE begins[2] = {begin.GetX( ), begin.GetY( )};
+  const VECTOR_TYPE ends[2] = {end.GetX( ), end.GetY( )};
+  const VECTOR_TYPE lows[2] = {diffraction_grating.Left( ), diffraction_grating.Top( )};
+  const VECTOR_TYPE highs[2] = {diffraction_grating.Right( ), diffraction_grating.Bottom( )};
+
+  float first_part = 0.;
+  float last_part = 1.;
+  for (int axis = 0; axis < 2; axis++)
+  {
+    const VECTOR_TYPE delta = ends[axis] - begins[axis];
+    if (delta == 0.)
+    {
+      if (begins[axis] < lows[axis] || begins[axis] > highs[axis])
+      {
+        return false;
+      }
+      continue;
+    }
+
+    float low_part = (lows[axis] - begins[axis]) / delta;
+    float high_part = (highs[axis] - begins[axis]) / delta;
+    if (low_part > high_part)
+    {
+      std::swap(low_part, high_part);
+    }
+
+    first_part = std::max(first_part, low_part);
+    last_part = std::min(last_part, high_part);
+    if (first_part > last_part)
+    {
+      return false;
+    }
+  }
+
+  *part = first_part;
+  return true;
 }
 
 
-bool Store::CheckCollisions(const FrontElement & front_element, const WAVE_STATUSES wave_status)
+bool Store::CheckCollisions(const Vector2 & begin, const Vector2 & end, const WAVE_STATUSES wave_status,
+                            int *grating_ind, Vector2 *position) const
 {
+  assert(grating_ind != nullptr);
+  assert(position != nullptr);
+
   if (wave_status != ORDINARY_WAVE)
   {
     return true;
   }
 
-  Vector2 front_element_position = front_element.GetPosition( );
-  VECTOR_TYPE front_element_x_position = front_element_position.GetX( );
-  for (int ind = 0; ind < diffraction_gratings_.size( ); ind++)
-  {
-    if (IsCollisions(front_element_position, diffraction_gratings_[ind]))
+  // Only gratings of cells of segment can collide. The first hit along segment is taken, and of gratings hit at
+  // the same point the one with the least index is taken.
+  float hit_part = 2.;
+  int hit_ind = -1;
+  grating_grid_.VisitCandidates(begin, end, [&](const int ind) {
+    float part = 0.;
+    if (IsCollisions(begin, end, diffraction_gratings_[ind], &part) &&
+        (part < hit_part || (part == hit_part && ind < hit_ind)))
     {
+      hit_part = part;
+      hit_ind = ind;
+    }
+  });
 
-      Vector2 secondary_source_coordinate;
-      bool is_main_wave = false;
+  if (hit_ind < 0)
+  {
+    return true;
+  }
 
-      int secondary_source_number = 0;
-      if (diffraction_gratings_[ind].HandleCollision(front_element_position, &secondary_source_coordinate,
-          &secondary_source_number, &is_main_wave))
-      {
-        Wave secondary_wave;
-        secondary_wave.Push(FrontElement(secondary_source_coordinate + DEFAULT_SECONDARY_WAVE_DISPLACEMENT));
+  // Hit point is clamped by box, so it collides as point too.
+  const DiffractionGrating & diffraction_grating = diffraction_gratings_[hit_ind];
+  const Vector2 hit_position = begin + (end - begin) * hit_part;
+  *position = Vector2(std::min(std::max(hit_position.GetX( ), diffraction_grating.Left( )),
+                               diffraction_grating.Right( )),
+                      std::min(std::max(hit_position.GetY( ), diffraction_grating.Top( )),
+                               diffraction_grating.Bottom( )));
+  *grating_ind = hit_ind;
+  return false;
+}
 
-        if (is_main_wave)
-        {
-          secondary_wave.SetWaveStatus(SECONDARY_MAIN_WAVE);
-        }
-        else
-        {
-          secondary_wave.SetWaveStatus(SECONDARY_WAVE);
-        }
+bool Store::HandleGratingCollision(const int grating_ind, const Vector2 & position)
+{
+  Vector2 secondary_source_coordinate;
+  bool is_main_wave = false;
 
-        secondary_wave.SetDiffractionGrating(&diffraction_gratings_[ind]);
-        secondary_wave.SetSecondarySourceNumber(secondary_source_number);
-        Push(secondary_wave);
-        
-        #ifdef CREATING_SECONDARY_WAVE_DEBAG
-        std::cout << "Add secondary wave with coordinates:\n";
-        std::cout << secondary_wave.GetMain( ).GetPosition( ) << std::endl;
-        #endif // End of CREATING_SECONDARY_WAVE_DEBAG.
-      }
-      return false;
+  SlotHandle secondary_source = NULL_SLOT_HANDLE;
+  if (diffraction_gratings_[grating_ind].HandleCollision(position, &secondary_source_coordinate,
+      &secondary_source, &is_main_wave))
+  {
+    // Wave is built in place in the end of waves_.
+    waves_.Emplace( );
+    Wave & secondary_wave = waves_.Back( );
+    secondary_wave.Push(FrontElement(secondary_source_coordinate + DEFAULT_SECONDARY_WAVE_DISPLACEMENT));
+
+    if (is_main_wave)
+    {
+      secondary_wave.SetWaveStatus(SECONDARY_MAIN_WAVE);
+    }
+    else
+    {
+      secondary_wave.SetWaveStatus(SECONDARY_WAVE);
     }
+
+    secondary_wave.SetGratingHandle(diffraction_gratings_.GetHandle(grating_ind));
+    secondary_wave.SetSecondarySourceHandle(secondary_source);
+    
+    #ifdef CREATING_SECONDARY_WAVE_DEBAG
+    std::cout << "Add secondary wave with coordinates:\n";
+    std::cout << secondary_wave.GetMain( ).GetPosition( ) << std::endl;
+    #endif // End of CREATING_SECONDARY_WAVE_DEBAG.
+
+    return true;
   }
-  return true;
+  return false;
 }
 
 
-bool Store::DrawHalfWave(sf::RenderWindow & window, const Vector2 & main_front_element_position, const bool is_top_part,
-                         const int wave_ind)
+Store::FrontKnot Store::GetFrontKnot(const Vector2 & position, const bool is_top_part, const int wave_ind,
+                                     PathPhasors *path, const bool is_curvature_needed) const
 {
-  Vector2 next_position = main_front_element_position;
-  FrontElement next = FrontElement(next_position);
-  float strength = 0.;
   static Vector2 reference_direction(0, 1);
 
+  const DiffractionGrating *diffraction_grating = nullptr;
+  if (waves_[wave_ind].GetWaveStatus( ) != ORDINARY_WAVE)
+  {
+    diffraction_grating = GetDiffractionGrating(waves_[wave_ind]);
+  }
+
+  Vector2 front_direction;
+  FieldJacobian jacobian;
+  bool is_jacobian_got = false;
+  if (is_curvature_needed)
+  {
+    is_jacobian_got = GetFieldStrength(position, diffraction_grating, &front_direction, &jacobian, path);
+  }
+  else
+  {
+    front_direction = GetFieldStrength(position, diffraction_grating, path);
+  }
+
+  const float strength = front_direction.Len( );
+  if (strength == 0.)
+  {
+    return FrontKnot{position, Vector2(0., 0.), 0., 0., false};
+  }
+  front_direction *= 1 / strength;
+
+  // it is to fixing wave looping
+  if (((front_direction * reference_direction) > 0 && is_top_part)
+      || (front_direction * reference_direction) < 0 && !is_top_part)
+  {
+    front_direction *= -1;
+  }
+
+  // Front line is tangent to field, so it turns by the part of derivative along it, which is normal to field.
+  float curvature = 0.;
+  if (is_jacobian_got)
+  {
+    const Vector2 derivative = jacobian.x_derivative * front_direction.GetX( ) +
+                               jacobian.y_derivative * front_direction.GetY( );
+    curvature = (derivative * front_direction.GetRotated90( )) / strength;
+  }
+
+  return FrontKnot{position, front_direction, strength, curvature, is_jacobian_got};
+}
+
+float Store::GetFrontTurnLength(const FrontKnot & knot) const
+{
+  assert(knot.is_curvature_known);
+
+  float turn = MAX_FRONT_TURN;
+
+  // Direction turns to x axis, if its y part decreases.
+  const float direction_y = knot.direction.GetY( );
+  if (direction_y * knot.curvature * knot.direction.GetX( ) < 0)
+  {
+    turn = std::min(turn, std::asin(std::min(1.f, std::fabs(direction_y))));
+  }
+
+  const float curvature = fabs(knot.curvature);
+  if (curvature * MAX_FRONT_STEP <= turn)
+  {
+    return MAX_FRONT_STEP;
+  }
+  return turn / curvature;
+}
+
+float Store::TakeFrontStep(const FrontKnot & knot, const bool is_top_part, const int wave_ind, PathPhasors *path,
+                           float *step, FrontKnot *next_knot) const
+{
+  assert(step != nullptr);
+  assert(next_knot != nullptr);
+
+  while (true)
+  {
+    const float length = *step;
+
+    // Bogacki-Shampine 3(2) pair. Direction in the end of step is the first stage of the next one.
+    const FrontKnot second = GetFrontKnot(knot.position + knot.direction * (length / 2), is_top_part, wave_ind,
+                                          path);
+    const FrontKnot third = GetFrontKnot(knot.position + second.direction * (3 * length / 4), is_top_part, wave_ind,
+                                         path);
+    *next_knot = GetFrontKnot(knot.position + (knot.direction * (2. / 9) + second.direction * (1. / 3) +
+                                               third.direction * (4. / 9)) * length, is_top_part, wave_ind, path,
+                              true);
+
+    const float error = ((knot.direction * (-5. / 72) + second.direction * (1. / 12) + third.direction * (1. / 9) -
+                          next_knot -> direction * (1. / 8)) * length).Len( );
+
+    // Error of step is proportional to length^3.
+    float factor = MAX_FRONT_STEP_FACTOR;
+    if (error > 0.)
+    {
+      factor = std::min(MAX_FRONT_STEP_FACTOR, std::max(MIN_FRONT_STEP_FACTOR,
+                                                        FRONT_STEP_SAFETY * std::cbrt(front_tolerance_ / error)));
+    }
+    float next_length = length * factor;
+
+    const bool is_accepted = error <= front_tolerance_ || length <= FRONT_ELEMENT_STEP;
+    if (is_accepted && next_knot -> is_curvature_known)
+    {
+      next_length = std::min(next_length, GetFrontTurnLength(*next_knot));
+    }
+    *step = std::min(MAX_FRONT_STEP, std::max(FRONT_ELEMENT_STEP, next_length));
+
+    if (is_accepted)
+    {
+      return length;
+    }
+
+    #ifdef STORE_DRAW_DEBUG
+    std::cout << "\trejected step: " << length << " error: " << error << std::endl;
+    #endif /* STORE_DRAW_DEBUG */
+  }
+}
+
+float Store::GetFirstFrontStep(const FrontKnot & knot) const
+{
+  if (knot.is_curvature_known)
+  {
+    return std::max(FRONT_ELEMENT_STEP, GetFrontTurnLength(knot));
+  }
+  return INITIAL_FRONT_STEP;
+}
+
+float Store::CorrectFrontStep(const FrontKnot & knot, const FrontPath & old_path, const size_t old_ind,
+                              const bool is_top_part, const int wave_ind, PathPhasors *path,
+                              FrontKnot *next_knot) const
+{
+  assert(next_knot != nullptr);
+  assert(old_ind > 0 && old_ind < old_path.positions.size( ));
+
+  const Vector2 old_chord = old_path.positions[old_ind] - old_path.positions[old_ind - 1];
+  const float length = old_chord.Len( );
+  if (length == 0.)
+  {
+    return 0.;
+  }
+
+  // Front moves a little between frames, so chord keeps its angle to tangent in the start of step.
+  const Vector2 & old_direction = old_path.directions[old_ind - 1];
+  const Rotation2 rotation(old_direction * knot.direction,
+                           old_direction.GetX( ) * knot.direction.GetY( ) -
+                           old_direction.GetY( ) * knot.direction.GetX( ));
+  Vector2 position = knot.position + old_chord.GetRotated(rotation);
+
+  for (int iteration = 0; iteration < MAX_FRONT_CORRECTIONS; iteration++)
+  {
+    *next_knot = GetFrontKnot(position, is_top_part, wave_ind, path);
+    if (next_knot -> strength == 0.)
+    {
+      return 0.;
+    }
+
+    // Front line is parallel to x axis here, so drawn side flips and DrawHalfWave( ) stops.
+    if (knot.direction * next_knot -> direction < 0)
+    {
+      return length;
+    }
+
+    const Vector2 bisector = knot.direction + next_knot -> direction;
+    const Vector2 corrected = knot.position + bisector * (length / sqrt(bisector.SquareLen( )));
+    const float shift = (corrected - position).SquareLen( );
+    position = corrected;
+
+    // Tangent is got nearer than tolerance to knot.
+    if (shift <= front_tolerance_ * front_tolerance_)
+    {
+      next_knot -> position = position;
+      return length;
+    }
+  }
+
+  return 0.;
+}
+
+bool Store::DrawHalfWave(const Vector2 & main_front_element_position, const bool is_top_part, const int wave_ind,
+                         WaveTrace *trace) const
+{
+  // Dipoles' phases change a little along front line, so they are rotated from anchors on path.
+  PathPhasors path;
+  PathPhasors *path_pointer = nullptr;
+  #ifdef USING_PATH_PHASORS
+  dipole_pack_.StartPath(&path, time_from_start);
+  path_pointer = &path;
+  #endif /* USING_PATH_PHASORS */
+
+  // Front moves a little between frames, so knots of the last frame are corrected one by one. Steps which aren't
+  // corrected and the rest of front line after old knots are traced. Curvature is needed only to trace.
+  const FrontPath & old_path = waves_[wave_ind].GetFrontPath(is_top_part);
+  size_t old_ind = old_path.positions.size( );
+  #ifdef USING_WARM_FRONTS
+  old_ind = 1;
+  #endif /* USING_WARM_FRONTS */
+  bool is_warm = old_ind < old_path.positions.size( );
+
+  FrontKnot knot = GetFrontKnot(main_front_element_position, is_top_part, wave_ind, path_pointer, !is_warm);
+  float step = GetFirstFrontStep(knot);
+
+  // Front elements are drawn every FRONT_ELEMENT_STEP along front line. It is distance from knot to the next one.
+  float element_offset = FRONT_ELEMENT_STEP;
+
   // It is to fixing wave looping.
   int element_number = 0;
 
   #ifdef STORE_DRAW_DEBUG
   std::cout << "Positive direction\n";
+  int steps_number = 0;
   #endif /* STORE_DRAW_DEBUG */
 
+  if (!FrontElement(main_front_element_position).IsOnScreen(GetDiffractionGrating(waves_[wave_ind])))
+  {
+    return true;
+  }
+
+  trace -> front_path.positions.push_back(knot.position);
+  trace -> front_path.directions.push_back(knot.direction);
+
+  // Collisions are checked on segments between neighbour front elements, so long steps don't miss thin gratings.
+  Vector2 previous_position = main_front_element_position;
+
   // second condition to fixing wave looping
-  while (next.IsOnScreen(waves_[wave_ind].GetDiffractionGrating( )) && (element_number < MAX_ELEMENT_NUMBER))
+  while (knot.strength != 0. && element_number < MAX_ELEMENT_NUMBER)
   {
-    Vector2 front_direction;
-    if (waves_[wave_ind].GetWaveStatus( ) == ORDINARY_WAVE)
+    FrontKnot next_knot;
+    float length = 0.;
+    if (old_ind < old_path.positions.size( ))
     {
-      front_direction = GetFieldStrength(next.GetPosition( ));
+      length = CorrectFrontStep(knot, old_path, old_ind, is_top_part, wave_ind, path_pointer, &next_knot);
+      if (length == 0.)
+      {
+        #ifdef STORE_DRAW_DEBUG
+        std::cout << "\tknot " << old_ind << " isn't corrected, trace it again" << std::endl;
+        #endif /* STORE_DRAW_DEBUG */
+
+        // Only this step is traced again. The next old knot is corrected from its end.
+        const float old_length = (old_path.positions[old_ind] - old_path.positions[old_ind - 1]).Len( );
+        step = std::min(MAX_FRONT_STEP, std::max(FRONT_ELEMENT_STEP, old_length));
+      }
+      old_ind++;
     }
-    else
+    else if (is_warm)
     {
-      front_direction = GetFieldStrength(next.GetPosition( ), waves_[wave_ind].GetDiffractionGrating( ));
+      // Front line is longer than in the last frame. The rest of it is traced.
+      is_warm = false;
+      knot = GetFrontKnot(knot.position, is_top_part, wave_ind, path_pointer, true);
+      if (knot.strength == 0.)
+      {
+        break;
+      }
+      step = GetFirstFrontStep(knot);
     }
 
-    strength = front_direction.Len( );
-    front_direction.Norm( );
-
-    // it is to fixing wave looping
-    if (((front_direction * reference_direction) > 0 && is_top_part)
-        || (front_direction * reference_direction) < 0 && !is_top_part)
+    if (length == 0.)
     {
-      front_direction *= -1;
+      length = TakeFrontStep(knot, is_top_part, wave_ind, path_pointer, &step, &next_knot);
     }
 
-    next_position += front_direction * FRONT_ELEMENT_STEP;
-
-
     #ifdef STORE_DRAW_DEBUG
-    std::cout << "\t" << element_number << " front_direction: " << front_direction <<
-                 " next_pos: " << next_position << " strength: " << strength << std::endl;
+    steps_number++;
+    std::cout << "\t" << element_number << " step: " << length << " next_pos: " << next_knot.position <<
+                 " strength: " << next_knot.strength << " curvature: " << next_knot.curvature << std::endl;
     #endif /* STORE_DRAW_DEBUG */
 
-    next = FrontElement(next_position);
+    trace -> front_path.positions.push_back(next_knot.position);
+    trace -> front_path.directions.push_back(next_knot.direction);
 
-    // Handle collisions with diffraction gratings. 
-    #ifdef USING_DIFFRACTION_GRATING
-    if (!CheckCollisions(next, waves_[wave_ind].GetWaveStatus( )))
+    // Front line is parallel to x axis here, so the drawn side flips at every step and wave would zigzag in place.
+    // Flipped knot is kept in path, so the next frame stops here too.
+    if (next_knot.direction * knot.direction < 0)
     {
-      DRAWN_SIDES old_drawn_side = waves_[wave_ind].GetDrawnSides();
+      break;
+    }
 
-      Wave new_wave;
-      new_wave.SetWaveStatus(ORDINARY_WAVE);
-      new_wave.Push(next);
-      if (old_drawn_side == BOTH_SIDES)
+    // Front line between knots is cubic Hermite spline by positions and directions.
+    for (; element_offset <= length && element_number < MAX_ELEMENT_NUMBER; element_offset += FRONT_ELEMENT_STEP)
+    {
+      const float part = element_offset / length;
+      const float square_part = part * part;
+      const float cube_part = square_part * part;
+      Vector2 next_position = knot.position * (2 * cube_part - 3 * square_part + 1) +
+                              knot.direction * ((cube_part - 2 * square_part + part) * length) +
+                              next_knot.position * (3 * square_part - 2 * cube_part) +
+                              next_knot.direction * ((cube_part - square_part) * length);
+      Vector2 front_direction = knot.direction * (1 - part) + next_knot.direction * part;
+      const float strength = knot.strength * (1 - part) + next_knot.strength * part;
+
+      FrontElement next = FrontElement(next_position);
+      if (!next.IsOnScreen(GetDiffractionGrating(waves_[wave_ind])))
       {
-        PushWaveMainElement(next_position, front_direction, 1);
-        PushWaveMainElement(next_position, front_direction, -1);
-        std::swap(waves_[wave_ind], waves_[waves_.size() - 1]);
-        waves_.pop_back();
-
-        #ifdef COLLISION_DEBAG
-        std::cout << "Double collision\n";
-        #endif
-        return false;
+        #ifdef STORE_DRAW_DEBUG
+        std::cout << "\t" << steps_number << " steps for " << element_number << " front elements" << std::endl;
+        #endif /* STORE_DRAW_DEBUG */
+        return true;
       }
-      if (is_top_part)
-      {
-        new_wave.SetDrawnSides(TOP_SIDE);
 
-        #ifdef COLLISION_DEBAG
-        std::cout << "Top collision!!!\n";
-        #endif
-      }
-      else
+      // Handle collisions with diffraction gratings. Wave is split after the pass. Look at QueueCollision( ).
+      #ifdef USING_DIFFRACTION_GRATING
+      int grating_ind = -1;
+      Vector2 collision_position;
+      if (!CheckCollisions(previous_position, next_position, waves_[wave_ind].GetWaveStatus( ), &grating_ind,
+                           &collision_position))
       {
-        new_wave.SetDrawnSides(BOTTOM_SIDE);
-
-        #ifdef COLLISION_DEBAG
-        std::cout << "Bottom collision!!!\n";
-        #endif
+        front_direction.Norm( );
+        trace -> is_collided = true;
+        trace -> collision = WaveCollision{grating_ind, collision_position, front_direction, false, is_top_part};
+        return false;
       }
-      Push(new_wave);
+      previous_position = next_position;
+      #endif
 
-      waves_[wave_ind].Swap(waves_[waves_.size( ) - 1]);
-      waves_.pop_back( );
-       
-      return false;
+      trace -> front_buffer.Push(next_position, strength);
+
+      element_number++;
     }
-    #endif
 
-    next.DrawColor(window, strength);
+    element_offset -= length;
+    knot = next_knot;
+  }
 
-    #ifdef DRAW_STEP_BY_STEP
-    sleep(1);
-    window.display();
-    #endif /* DRAW_STEP_BY_STEP */
+  #ifdef STORE_DRAW_DEBUG
+  std::cout << "\t" << steps_number << " steps for " << element_number << " front elements" << std::endl;
+  #endif /* STORE_DRAW_DEBUG */
 
-   element_number++;
-  }
   return true;
 }
 
-void Store::PushWaveMainElement(const Vector2 & position, Vector2 & direction, const signed char factor)
+void Store::QueueWavePart(const Vector2 & position, Vector2 & direction, const signed char factor)
 {
   static Vector2 reference_direction(0, 1);
-  Wave part_wave;
   if ((direction * reference_direction * factor) > 0)
   {
     direction *= -1;
   }
-  part_wave.Push(FrontElement(position + direction * FRONT_ELEMENT_STEP * COLLISIION_SCALE));
-  if (factor == 1)
-  {
-    part_wave.SetDrawnSides(TOP_SIDE);
-  }
-  else
-  {
-    part_wave.SetDrawnSides(BOTTOM_SIDE);
-  }
-  Push(part_wave);
+  const Vector2 part_position = position + direction * FRONT_ELEMENT_STEP * COLLISIION_SCALE;
+  collision_events_.push_back(CollisionEvent{SPLIT_EVENT, -1, part_position, factor == 1 ? TOP_SIDE : BOTTOM_SIDE});
   return;
 }
 
-bool Store::HandleWave(sf::RenderWindow & window, Wave &wave, const int wave_ind)
+bool Store::HandleWave(const int wave_ind, const bool is_top_part, WaveTrace *trace) const
 {
+    assert(trace != nullptr);
 
-    FrontElement & main_front_element = wave.GetMain();
+    const Wave & wave = waves_[wave_ind];
+    const FrontElement & main_front_element = wave.GetMain();
 
     Vector2 main_front_element_position = main_front_element.GetPosition();
-    Vector2 front_direction;
-    if (wave.GetWaveStatus( ) == ORDINARY_WAVE)
+
+    // Main front element belongs to top half. Bottom half only checks it to stop with top half.
+    bool is_main_collided = false;
+    #ifdef USING_DIFFRACTION_GRATING
+    int grating_ind = -1;
+    Vector2 collision_position;
+    is_main_collided = !CheckCollisions(main_front_element_position, main_front_element_position,
+                                        wave.GetWaveStatus( ), &grating_ind, &collision_position);
+    if (!is_top_part && is_main_collided)
     {
-      front_direction = GetFieldStrength(main_front_element_position);
+      return false;
     }
-    else
+    #endif // USING_DIFFRACTION_GRATINGS.
+
+    // Front is extracted by DrawContourFronts( ), so only collision of main front element is handled.
+    if (is_contour_fronts_ && wave.GetWaveStatus( ) == ORDINARY_WAVE && !is_main_collided)
     {
-      front_direction = GetFieldStrength(main_front_element_position, wave.GetDiffractionGrating( ));
+      return true;
     }
 
-    main_front_element.DrawColor(window, front_direction.Len( ));
-
-    // Handle collisions with diffraction gratings. 
-    #ifdef USING_DIFFRACTION_GRATING
-    if (!CheckCollisions(wave.GetMain( ), wave.GetWaveStatus( )))
+    if (is_top_part)
     {
-      DRAWN_SIDES old_drawn_side = wave.GetDrawnSides();
-      front_direction.Norm( );
+      Vector2 front_direction;
+      if (wave.GetWaveStatus( ) == ORDINARY_WAVE)
+      {
+        front_direction = GetFieldStrength(main_front_element_position);
+      }
+      else
+      {
+        front_direction = GetFieldStrength(main_front_element_position, GetDiffractionGrating(wave));
+      }
 
-      static Vector2 reference_direction(0, 1);
+      trace -> front_buffer.Push(main_front_element_position, front_direction.Len( ));
 
-      if (old_drawn_side != TOP_SIDE)
+      // Handle collisions with diffraction gratings. Wave is split after the pass. Look at QueueCollision( ).
+      #ifdef USING_DIFFRACTION_GRATING
+      if (is_main_collided)
       {
-        PushWaveMainElement(main_front_element_position, front_direction, -1);
+        front_direction.Norm( );
+        trace -> is_collided = true;
+        trace -> collision = WaveCollision{grating_ind, main_front_element_position, front_direction, true, false};
+        return false;
       }
+      #endif // USING_DIFFRACTION_GRATINGS.
 
+      #ifdef STORE_DRAW_DEBUG
+      std::cout << "Main: " << main_front_element_position << " strength: " << front_direction.Len( ) << std::endl;
+      #endif /* STORE_DRAW_DEBUG */
+    }
 
-      if (old_drawn_side != BOTTOM_SIDE)
-      {
-        PushWaveMainElement(main_front_element_position, front_direction, 1);
-      } 
 
-      waves_[wave_ind].Swap(waves_[waves_.size() - 1]);
-      waves_.pop_back();  
+    #ifdef DRAW_ALL_FRONT_ELEMENTS
+    if (wave.GetDrawnSides( ) == (is_top_part ? BOTTOM_SIDE : TOP_SIDE))
+    {
+      return true;
+    }
+
+    // Draw top or bottom part.
+    return DrawHalfWave(main_front_element_position, is_top_part, wave_ind, trace);
+    #else
+    return true;
+    #endif /* DRAW_ALL_FRONT_ELEMENTS */
+}
 
-      #ifdef COLLISION_DEBAG
-      std::cout << "Collision of main element!!!\n";
-      #endif
+void Store::QueueCollision(const int wave_ind, const WaveCollision & collision)
+{
+  collision_events_.push_back(CollisionEvent{SPAWN_EVENT, collision.grating_ind, collision.position, BOTH_SIDES});
 
-      return false;
+  const DRAWN_SIDES old_drawn_side = waves_[wave_ind].GetDrawnSides( );
+  Vector2 front_direction = collision.front_direction;
+
+  if (collision.is_main_element)
+  {
+    if (old_drawn_side != TOP_SIDE)
+    {
+      QueueWavePart(collision.position, front_direction, -1);
     }
-    #endif // USING_DIFFRACTION_GRATINGS.
 
+    if (old_drawn_side != BOTTOM_SIDE)
+    {
+      QueueWavePart(collision.position, front_direction, 1);
+    }
 
-    #ifdef STORE_DRAW_DEBUG
-    std::cout << "Main: " << main_front_element_position << " strength: " << strength << std::endl;
-    #endif /* STORE_DRAW_DEBUG */
+    #ifdef COLLISION_DEBAG
+    std::cout << "Collision of main element!!!\n";
+    #endif
 
+    return;
+  }
 
-    #ifdef DRAW_ALL_FRONT_ELEMENTS
+  if (old_drawn_side == BOTH_SIDES)
+  {
+    QueueWavePart(collision.position, front_direction, 1);
+    QueueWavePart(collision.position, front_direction, -1);
+
+    #ifdef COLLISION_DEBAG
+    std::cout << "Double collision\n";
+    #endif
 
-    if (wave.GetDrawnSides( ) != BOTTOM_SIDE)
+    return;
+  }
+
+  DRAWN_SIDES drawn_sides = BOTTOM_SIDE;
+  if (collision.is_top_part)
+  {
+    drawn_sides = TOP_SIDE;
+
+    #ifdef COLLISION_DEBAG
+    std::cout << "Top collision!!!\n";
+    #endif
+  }
+  else
+  {
+    #ifdef COLLISION_DEBAG
+    std::cout << "Bottom collision!!!\n";
+    #endif
+  }
+  collision_events_.push_back(CollisionEvent{SPLIT_EVENT, -1, collision.position, drawn_sides});
+
+  return;
+}
+
+void Store::ResolveCollisionEvents(void)
+{
+  std::vector<bool> is_grating_changed(diffraction_gratings_.Size( ), false);
+
+  for (const CollisionEvent & collision_event : collision_events_)
+  {
+    if (collision_event.type == SPAWN_EVENT)
     {
-      // Draw top part.
-      if (!DrawHalfWave(window, main_front_element_position, true, wave_ind))
+      if (HandleGratingCollision(collision_event.grating_ind, collision_event.position))
       {
-        return false;
+        is_grating_changed[collision_event.grating_ind] = true;
       }
+      continue;
     }
 
-    if (wave.GetDrawnSides( ) != TOP_SIDE)
+    waves_.Emplace( );
+    Wave & part_wave = waves_.Back( );
+    part_wave.SetWaveStatus(ORDINARY_WAVE);
+    part_wave.Push(FrontElement(collision_event.position));
+    part_wave.SetDrawnSides(collision_event.drawn_sides);
+  }
+  collision_events_.clear( );
+
+  // New secondary sources give field only after their base field strengths are known.
+  for (size_t ind = 0; ind < diffraction_gratings_.Size( ); ind++)
+  {
+    if (is_grating_changed[ind])
     {
-      // Draw bottom part.
-      if (!DrawHalfWave(window, main_front_element_position, false, wave_ind))
-      {
-        return false;
-      }
-      #endif /* DRAW_ALL_FRONT_ELEMENTS */
+      diffraction_gratings_[ind].UpdateBaseFieldStrengths(dipole_pack_, time_from_start);
     }
+  }
 
-    return true;
+  return;
 }
 
-bool Store::HandleAllWaves(sf::RenderWindow & window)
+size_t Store::HandleWaves(const size_t first_wave)
 {
-  for (int ind = 0; ind < waves_.size( ); ind++)
+  const size_t waves_number = waves_.Size( );
+  if (wave_traces_.size( ) < 2 * (waves_number - first_wave))
+  {
+    wave_traces_.resize(2 * (waves_number - first_wave));
+  }
+
+  // Halves of waves have very different lengths, so every half is a chunk. Thread pool balances them by stealing.
+  // Every half writes only its own trace.
+  thread_pool_.ParallelFor(2 * (waves_number - first_wave), 1, [&](const size_t begin, const size_t end) {
+    for (size_t ind = begin; ind < end; ind++)
+    {
+      WaveTrace & trace = wave_traces_[ind];
+      trace.front_buffer.Clear( );
+      trace.front_path.Clear( );
+      trace.is_collided = false;
+      HandleWave(first_wave + ind / 2, ind % 2 == 0, &trace);
+    }
+  });
+
+  // Traces are applied in order of waves, so result doesn't depend on threads. New waves are pushed in the end.
+  // Bottom half is dropped, if top half collided, as it was never traced before the collision.
+  size_t collided_number = 0;
+  for (size_t ind = first_wave; ind < waves_number; ind++)
   {
-    if (!HandleWave(window, waves_[ind], ind))
+    WaveTrace & top_trace = wave_traces_[2 * (ind - first_wave)];
+    WaveTrace & bottom_trace = wave_traces_[2 * (ind - first_wave) + 1];
+    front_buffer_.Append(top_trace.front_buffer);
+    if (!top_trace.is_collided)
     {
-      return false;
-    } 
+      front_buffer_.Append(bottom_trace.front_buffer);
+      top_trace.is_collided = bottom_trace.is_collided;
+      top_trace.collision = bottom_trace.collision;
+    }
+
+    if (top_trace.is_collided)
+    {
+      QueueCollision(ind, top_trace.collision);
+      collided_number++;
+    }
+    else
+    {
+      // Traced halves are the warm start of the next frame. Old paths give their memory to traces.
+      waves_[ind].SwapFrontPath(true, top_trace.front_path);
+      waves_[ind].SwapFrontPath(false, bottom_trace.front_path);
+    }
   }
-  return true;
+
+  // Parts of collided waves and secondary waves are pushed in the end, they are traced by the next pass.
+  ResolveCollisionEvents( );
+
+  // Collided waves are replaced by their parts, so they are removed keeping order of others.
+  waves_.RemoveOrdered(first_wave, [&](const size_t ind) {
+    return ind < waves_number && wave_traces_[2 * (ind - first_wave)].is_collided;
+  });
+
+  // New waves are after not collided waves of the pass.
+  return waves_number - collided_number;
 }
 
 
@@ -320,10 +739,31 @@ bool Store::Draw(sf::RenderWindow & window) {
 
   unsigned int dipoles_number = dipoles_.size();
 
-  // Find description in documentation to this function.
-  while (!HandleAllWaves(window)) {
+  UpdatePhasorGrid( );
+  UpdateDipoleTree( );
+
+  // Field of dipoles in secondary sources is the same for all points of this frame.
+  for (auto & diffraction_grating : diffraction_gratings_)
+  {
+    diffraction_grating.UpdateBaseFieldStrengths(dipole_pack_, time_from_start);
+  }
+
+  // Every wave is traced once. Waves created by collisions of pass are traced by the next pass.
+  front_buffer_.Clear( );
+  if (is_contour_fronts_)
+  {
+    DrawContourFronts( );
+  }
+
+  size_t first_wave = 0;
+  while (first_wave < waves_.Size( ))
+  {
+    first_wave = HandleWaves(first_wave);
   }
 
+  // All fronts of frame are drawn by one call.
+  front_buffer_.Draw(window);
+
 
   // For 10 waves it is neccesary approximately 0.537001, for one wave 0.0534042.
   #ifdef DRAW_STORE_TIMER
@@ -340,7 +780,12 @@ bool Store::Push(const Dipole & dipole)
   std::cout << "Store::Push(dipole)" << std::endl;
   #endif /* STORE_DEBUG */
 
+  // Field of new dipole will be added to phasor_grid_ in UpdatePhasorGrid( ) and to iso_contours_ in
+  // DrawContourFronts( ).
   dipoles_.push_back(dipole);
+  dipole_pack_.Push(dipole);
+  dipole_tree_.Invalidate( );
+  linear_arrays_.Push(dipole_pack_);
 
   #ifdef STORE_DEBUG
   std::cout << "Store::Push(dipole) end" << std::endl;
@@ -351,12 +796,17 @@ bool Store::Push(const Dipole & dipole)
 }
 
 bool Store::Push(const Wave & wave)
+{
+  return Push(Wave(wave));
+}
+
+bool Store::Push(Wave && wave)
 {
   #ifdef STORE_DEBUG
   std::cout << "Store::Push(wave)" << std::endl;
   #endif /* STORE_DEBUG */
 
-  waves_.push_back(wave);
+  waves_.Push(std::move(wave));
 
   #ifdef STORE_DEBUG
   std::cout << "Store::Push(wave) end" << std::endl;
@@ -367,12 +817,18 @@ bool Store::Push(const Wave & wave)
 }
 
 bool Store::Push(const DiffractionGrating & diffraction_grating)
+{
+  return Push(DiffractionGrating(diffraction_grating));
+}
+
+bool Store::Push(DiffractionGrating && diffraction_grating)
 {
   #ifdef STORE_DEBUG
   std::cout << "Store::Push(diffraction_grating)" << std::endl;
   #endif /* STORE_DEBUG */
 
-  diffraction_gratings_.push_back(diffraction_grating);
+  diffraction_gratings_.Push(std::move(diffraction_grating));
+  grating_grid_.Build(diffraction_gratings_);
 
   #ifdef STORE_DEBUG
   std::cout << "Store::Push(diffraction_grating) end" << std::endl;
@@ -382,6 +838,96 @@ bool Store::Push(const DiffractionGrating & diffraction_grating)
   return true;
 }
 
+bool Store::RemoveDipole(const size_t ind)
+{
+  if (ind >= dipoles_.size( ))
+  {
+    return false;
+  }
+
+  #ifdef STORE_DEBUG
+  std::cout << "Store::RemoveDipole(" << ind << ")" << std::endl;
+  #endif /* STORE_DEBUG */
+
+  // Field of dipole is subtracted while it is in dipole_pack_.
+  if (ind < phasor_grid_dipoles_number_)
+  {
+    #ifdef USING_PHASOR_GRID
+    if (phasor_grid_.IsValid( ))
+    {
+      phasor_grid_.Update(dipole_pack_, ind, ind + 1, -1., thread_pool_);
+    }
+    #endif /* USING_PHASOR_GRID */
+
+    phasor_grid_dipoles_number_--;
+  }
+
+  if (ind < iso_contours_dipoles_number_)
+  {
+    if (iso_contours_.IsValid( ))
+    {
+      iso_contours_.Update(dipole_pack_, ind, ind + 1, -1., thread_pool_);
+    }
+
+    iso_contours_dipoles_number_--;
+  }
+
+  dipoles_.erase(dipoles_.begin( ) + ind);
+  dipole_pack_.Remove(ind);
+  dipole_tree_.Invalidate( );
+  linear_arrays_.Build(dipole_pack_);
+
+  return true;
+}
+
+size_t Store::GetDipolesNumber(void) const
+{
+  return dipoles_.size( );
+}
+
+void Store::SetFieldTolerance(const float tolerance)
+{
+  assert(tolerance >= 0.);
+  field_tolerance_ = tolerance;
+
+  #ifdef USING_PHASOR_GRID
+  if (tolerance > 0.)
+  {
+    phasor_grid_.SetTolerance(tolerance);
+  }
+  #endif /* USING_PHASOR_GRID */
+
+  return;
+}
+
+float Store::GetFieldTolerance(void) const
+{
+  return field_tolerance_;
+}
+
+void Store::SetFrontTolerance(const float tolerance)
+{
+  assert(tolerance > 0.);
+  front_tolerance_ = tolerance;
+  return;
+}
+
+float Store::GetFrontTolerance(void) const
+{
+  return front_tolerance_;
+}
+
+void Store::SetContourFronts(const bool is_contour_fronts)
+{
+  is_contour_fronts_ = is_contour_fronts;
+  return;
+}
+
+bool Store::IsContourFronts(void) const
+{
+  return is_contour_fronts_;
+}
+
 bool Store::Dump() const
 {
   #ifdef STORE_DEBUG
@@ -394,7 +940,7 @@ bool Store::Dump() const
     dipole.Dump();
   }
 
-  std::cout << "Print waves_: " << waves_.size() << std::endl;
+  std::cout << "Print waves_: " << waves_.Size( ) << std::endl;
   for(auto& wave : waves_)
     wave.Dump();
 
@@ -406,32 +952,56 @@ bool Store::Dump() const
   return true;
 }
 
-Vector2 Store::GetFieldStrength(const my_math::Vector2 & position,
-                                        const DiffractionGrating *diffraction_grating) const
+Vector2 Store::GetFieldStrength(const my_math::Vector2 & position, const DiffractionGrating *diffraction_grating,
+                                PathPhasors *path) const
 {
   #ifdef GET_FIELD_STRENTH_TIMER
   std::chrono::high_resolution_clock::time_point debag_time_stamp = std::chrono::high_resolution_clock::now();
   #endif
 
   Vector2 result(0, 0);
-  std::vector<std::future<Vector2> > f;
+
+  #ifdef USING_PHASOR_GRID
+  if (!diffraction_grating && IsPhasorGridUsed(position))
+  {
+    return phasor_grid_.GetFieldStrength(position);
+  }
+  #endif /* USING_PHASOR_GRID */
+
+  if (!diffraction_grating && IsFieldApproximated( ))
+  {
+    return GetApproximateFieldStrength(position);
+  }
 
   if (!diffraction_grating)
   {
-    for (auto& dipole : dipoles_)
+    // Not more than MAX_FIELD_CHUNKS chunks, so partial sums are kept on stack.
+    const size_t dipoles_number = dipoles_.size( );
+    const size_t chunk_size = std::max(FIELD_CHUNK_SIZE, (dipoles_number + MAX_FIELD_CHUNKS - 1) / MAX_FIELD_CHUNKS);
+    Vector2 chunk_results[MAX_FIELD_CHUNKS];
+
+    // Chunks are disjoint, so they share path.
+    thread_pool_.ParallelFor(dipoles_number, chunk_size, [&](const size_t begin, const size_t end) {
+      if (path)
+      {
+        chunk_results[begin / chunk_size] = dipole_pack_.GetFieldStrength(position, time_from_start, begin, end,
+                                                                          path);
+      }
+      else
+      {
+        chunk_results[begin / chunk_size] = dipole_pack_.GetFieldStrength(position, time_from_start, begin, end);
+      }
+    });
+
+    for (size_t ind = 0; ind * chunk_size < dipoles_number; ind++)
     {
-      f.push_back(std::async([&]() {
-        return dipole.GetFieldStrength(position, time_from_start);
-        })
-      );
+      result += chunk_results[ind];
     }
-    for (auto& i : f)
-      result += i.get();;
   }
 
   else
   {
-    result = (*diffraction_grating).GetFieldStrength(position, time_from_start, dipoles_);
+    result = (*diffraction_grating).GetFieldStrength(position, time_from_start);
 
     #ifdef SECONDARY_SOURCE_STRENGTH_DEBAG
     std::cout << "\nposition = " << position << std::endl;
@@ -448,6 +1018,245 @@ Vector2 Store::GetFieldStrength(const my_math::Vector2 & position,
   return result;
 }
 
+bool Store::GetFieldStrength(const my_math::Vector2 & position, const DiffractionGrating *diffraction_grating,
+                             my_math::Vector2 *field_strength, FieldJacobian *jacobian, PathPhasors *path) const
+{
+  assert(field_strength != nullptr);
+  assert(jacobian != nullptr);
+
+  if (diffraction_grating)
+  {
+    *field_strength = (*diffraction_grating).GetFieldStrength(position, time_from_start, jacobian);
+    return true;
+  }
+
+  #ifdef USING_PHASOR_GRID
+  if (IsPhasorGridUsed(position))
+  {
+    *field_strength = phasor_grid_.GetFieldStrength(position, jacobian);
+    return true;
+  }
+  #endif /* USING_PHASOR_GRID */
+
+  if (IsFieldApproximated( ))
+  {
+    *field_strength = GetApproximateFieldStrength(position);
+    return false;
+  }
+
+  // Not more than MAX_FIELD_CHUNKS chunks, so partial sums are kept on stack.
+  const size_t dipoles_number = dipoles_.size( );
+  const size_t chunk_size = std::max(FIELD_CHUNK_SIZE, (dipoles_number + MAX_FIELD_CHUNKS - 1) / MAX_FIELD_CHUNKS);
+  Vector2 chunk_results[MAX_FIELD_CHUNKS];
+  FieldJacobian chunk_jacobians[MAX_FIELD_CHUNKS];
+
+  thread_pool_.ParallelFor(dipoles_number, chunk_size, [&](const size_t begin, const size_t end) {
+    FieldJacobian *chunk_jacobian = &chunk_jacobians[begin / chunk_size];
+    if (path)
+    {
+      chunk_results[begin / chunk_size] = dipole_pack_.GetFieldStrength(position, time_from_start, begin, end,
+                                                                        chunk_jacobian, path);
+    }
+    else
+    {
+      chunk_results[begin / chunk_size] = dipole_pack_.GetFieldStrength(position, time_from_start, begin, end,
+                                                                        chunk_jacobian);
+    }
+  });
+
+  *field_strength = Vector2(0., 0.);
+  *jacobian = FieldJacobian{Vector2(0., 0.), Vector2(0., 0.)};
+  for (size_t ind = 0; ind * chunk_size < dipoles_number; ind++)
+  {
+    *field_strength += chunk_results[ind];
+    jacobian -> x_derivative += chunk_jacobians[ind].x_derivative;
+    jacobian -> y_derivative += chunk_jacobians[ind].y_derivative;
+  }
+
+  return true;
+}
+
+void Store::GetFieldStrength(const my_math::Vector2 *positions, my_math::Vector2 *field_strengths,
+                             const size_t points_number, const DiffractionGrating *diffraction_grating) const
+{
+  assert(positions != nullptr);
+  assert(field_strengths != nullptr);
+
+  thread_pool_.ParallelFor(points_number, FIELD_POINTS_TILE, [&](const size_t begin, const size_t end) {
+    #ifdef USING_PHASOR_GRID
+    if (!diffraction_grating && field_tolerance_ > 0. && phasor_grid_.IsValid( ))
+    {
+      // Points out of grid are summed exactly by one batch.
+      Vector2 exact_positions[FIELD_POINTS_TILE];
+      Vector2 exact_field_strengths[FIELD_POINTS_TILE];
+      size_t exact_indices[FIELD_POINTS_TILE];
+      size_t exact_number = 0;
+
+      for (size_t ind = begin; ind < end; ind++)
+      {
+        if (phasor_grid_.Contains(positions[ind]))
+        {
+          field_strengths[ind] = phasor_grid_.GetFieldStrength(positions[ind]);
+        }
+        else
+        {
+          exact_positions[exact_number] = positions[ind];
+          exact_indices[exact_number] = ind;
+          exact_number++;
+        }
+      }
+
+      if (IsFieldApproximated( ))
+      {
+        for (size_t ind = 0; ind < exact_number; ind++)
+        {
+          field_strengths[exact_indices[ind]] = GetApproximateFieldStrength(exact_positions[ind]);
+        }
+        return;
+      }
+
+      dipole_pack_.GetFieldStrength(exact_positions, exact_field_strengths, exact_number, time_from_start);
+      for (size_t ind = 0; ind < exact_number; ind++)
+      {
+        field_strengths[exact_indices[ind]] = exact_field_strengths[ind];
+      }
+      return;
+    }
+    #endif /* USING_PHASOR_GRID */
+
+    if (!diffraction_grating && IsFieldApproximated( ))
+    {
+      for (size_t ind = begin; ind < end; ind++)
+      {
+        field_strengths[ind] = GetApproximateFieldStrength(positions[ind]);
+      }
+      return;
+    }
+
+    if (!diffraction_grating)
+    {
+      dipole_pack_.GetFieldStrength(positions + begin, field_strengths + begin, end - begin, time_from_start);
+    }
+    else
+    {
+      diffraction_grating -> GetFieldStrength(positions + begin, field_strengths + begin, end - begin,
+                                              time_from_start);
+    }
+  });
+
+  return;
+}
+
+void Store::UpdatePhasorGrid(void)
+{
+  #ifdef USING_PHASOR_GRID
+  // Grid isn't kept for exact summation.
+  if (field_tolerance_ <= 0.)
+  {
+    phasor_grid_.Invalidate( );
+  }
+  else if (!phasor_grid_.IsValid( ))
+  {
+    phasor_grid_.Build(dipole_pack_, thread_pool_);
+    phasor_grid_.SetTime(time_from_start);
+  }
+  else if (phasor_grid_dipoles_number_ < dipole_pack_.Size( ))
+  {
+    // New dipoles cost O(grid) each, not O(grid * dipoles).
+    phasor_grid_.Update(dipole_pack_, phasor_grid_dipoles_number_, dipole_pack_.Size( ), 1., thread_pool_);
+  }
+  #endif /* USING_PHASOR_GRID */
+
+  phasor_grid_dipoles_number_ = dipole_pack_.Size( );
+
+  return;
+}
+
+void Store::UpdateDipoleTree(void)
+{
+  #ifdef USING_DIPOLE_TREE
+  if (!dipole_tree_.IsValid( ) && field_tolerance_ > 0. && dipole_pack_.Size( ) >= DIPOLE_TREE_MIN_DIPOLES)
+  {
+    dipole_tree_.Build(dipole_pack_);
+  }
+  #endif /* USING_DIPOLE_TREE */
+
+  return;
+}
+
+void Store::DrawContourFronts(void)
+{
+  if (!iso_contours_.IsValid( ))
+  {
+    iso_contours_.Build(dipole_pack_, thread_pool_);
+  }
+  else if (iso_contours_dipoles_number_ < dipole_pack_.Size( ))
+  {
+    // New dipoles cost O(grid) each, not O(grid * dipoles).
+    iso_contours_.Update(dipole_pack_, iso_contours_dipoles_number_, dipole_pack_.Size( ), 1., thread_pool_);
+  }
+  iso_contours_dipoles_number_ = dipole_pack_.Size( );
+
+  main_positions_.clear( );
+  for (const Wave & wave : waves_)
+  {
+    if (wave.GetWaveStatus( ) == ORDINARY_WAVE)
+    {
+      main_positions_.push_back(wave.GetMain( ).GetPosition( ));
+    }
+  }
+
+  iso_contours_.Extract(dipole_pack_, time_from_start, main_positions_.data( ), main_positions_.size( ), thread_pool_,
+                        &front_buffer_);
+  return;
+}
+
+const DiffractionGrating * Store::GetDiffractionGrating(const Wave & wave) const
+{
+  return diffraction_gratings_.Get(wave.GetGratingHandle( ));
+}
+
+bool Store::IsDipoleTreeUsed(void) const
+{
+  #ifdef USING_DIPOLE_TREE
+  return field_tolerance_ > 0. && dipole_pack_.Size( ) >= DIPOLE_TREE_MIN_DIPOLES && dipole_tree_.IsValid( );
+  #else
+  return false;
+  #endif /* USING_DIPOLE_TREE */
+}
+
+bool Store::IsPhasorGridUsed(const Vector2 & position) const
+{
+  #ifdef USING_PHASOR_GRID
+  return field_tolerance_ > 0. && phasor_grid_.IsValid( ) && phasor_grid_.Contains(position);
+  #else
+  return false;
+  #endif /* USING_PHASOR_GRID */
+}
+
+bool Store::IsFieldApproximated(void) const
+{
+  #ifdef USING_LINEAR_ARRAYS
+  if (field_tolerance_ > 0. && linear_arrays_.HasArrays( ))
+  {
+    return true;
+  }
+  #endif /* USING_LINEAR_ARRAYS */
+
+  return IsDipoleTreeUsed( );
+}
+
+Vector2 Store::GetApproximateFieldStrength(const Vector2 & position) const
+{
+  // Tree collapses arrays too, so it is used for many dipoles.
+  if (IsDipoleTreeUsed( ))
+  {
+    return dipole_tree_.GetFieldStrength(position, time_from_start, field_tolerance_);
+  }
+
+  return linear_arrays_.GetFieldStrength(dipole_pack_, position, time_from_start, field_tolerance_);
+}
+
 bool Store::UpdateTime()
 {
   static std::chrono::high_resolution_clock::time_point time_stamp = time_start;
@@ -459,6 +1268,8 @@ bool Store::UpdateTime()
   t = diff.count() / TIME_SCALE;
 
   time_from_start += t;
+
+  phasor_grid_.SetTime(time_from_start);
 }
 
 float Store::GetTime( )
@@ -468,41 +1279,36 @@ float Store::GetTime( )
 
 bool Store::RemoveDistantWaves( )
 {
-  for (int i = 0; i < waves_.size(); i++)
+  for (int i = 0; i < waves_.Size( ); i++)
   {
     WAVE_STATUSES wave_status = waves_[i].GetWaveStatus( );
-    if (wave_status == SECONDARY_WAVE && waves_[i].IsInterfere( ))
+    DiffractionGrating *diffraction_grating = diffraction_gratings_.Get(waves_[i].GetGratingHandle( ));
+    if (wave_status == SECONDARY_WAVE && diffraction_grating != nullptr && waves_[i].IsInterfere(*diffraction_grating))
     {
-      waves_[i].Swap(waves_[waves_.size() - 1]);
-      waves_.pop_back();
+      waves_.RemoveAt(i);
       i--;
     }
 
     else if (waves_[i].GetMain( ).IsFarFromCenter(wave_status, waves_[i].GetDrawnSides( )))
     {
-      // Remove appropriate secondary source.
-      if (wave_status == SECONDARY_WAVE)
+      // Remove appropriate secondary source. Handle of source is stale, if its slot was cleared and used again.
+      if (wave_status == SECONDARY_WAVE && diffraction_grating != nullptr)
       {
-        waves_[i].GetDiffractionGrating( ) -> RemoveSecondarySource(waves_[i].GetSecondarySourceNumber( ), wave_status);
+        diffraction_grating -> RemoveSecondarySource(waves_[i].GetSecondarySourceHandle( ), wave_status);
       }
 
-      else if (wave_status == SECONDARY_MAIN_WAVE)
+      else if (wave_status == SECONDARY_MAIN_WAVE && diffraction_grating != nullptr)
       {
-        DiffractionGrating& diffraction_grating = *waves_[i].GetDiffractionGrating( );
-        for (int ind = 0; ind < diffraction_grating.GetNumberHatches( ) - 1; ind++)
-        {
-          diffraction_grating.RemoveSecondarySource(ind, wave_status);
-        }
+        diffraction_grating -> RemoveSecondarySources( );
       }
 
-      waves_[i].Swap(waves_[waves_.size() - 1]);
-      waves_.pop_back();
+      waves_.RemoveAt(i);
       i--;
     }
   }
 
   #ifdef MEMORY_LEAKS_DEBUG
-  int number_waves = waves_.size( );
+  int number_waves = waves_.Size( );
   std::cout << "Number waves:\t" << number_waves << std::endl;
   std::cout << "Main front element coordinates:\n";
   for (int ind = 0; ind < number_waves; ind++)
@@ -529,18 +1335,24 @@ bool Store::MoveWaves()
 
   float t = GetTime();
 
-  std::vector<std::future<bool> > f;
-  for (auto& i : waves_)
+  UpdatePhasorGrid( );
+  UpdateDipoleTree( );
+
+  // Field in all main front elements is got by one batch.
+  main_positions_.resize(waves_.Size( ));
+  main_field_strengths_.resize(waves_.Size( ));
+  for (size_t ind = 0; ind < waves_.Size( ); ind++)
   {
-    f.push_back(std::async([&]() {
-      MoveWave(i);
-      return true;
-      })
-    );
+    main_positions_[ind] = waves_[ind].GetMain( ).GetPosition( );
   }
+  GetFieldStrength(main_positions_.data( ), main_field_strengths_.data( ), waves_.Size( ));
 
-  for(auto& result : f) 
-    result.get();
+  thread_pool_.ParallelFor(waves_.Size( ), MOVE_WAVES_CHUNK_SIZE, [&](const size_t begin, const size_t end) {
+    for (size_t ind = begin; ind < end; ind++)
+    {
+      MoveWave(waves_[ind], main_field_strengths_[ind]);
+    }
+  });
 
   #ifdef STORE_DEBUG
   std::cout << "Store::MoveWaves() end" << std::endl;
@@ -556,13 +1368,12 @@ bool Store::MoveWaves()
 }
 
 
-bool Store::MoveWave(Wave & wave)
+bool Store::MoveWave(Wave & wave, const Vector2 & field_strength)
 {
   FrontElement & front_element = wave.GetMain( );
   Vector2 position = front_element.GetPosition( );
 
-  Vector2 field_strength = GetFieldStrength(front_element.GetPosition( ));
-  Vector2 speed_direction = field_strength.GetRotated(-90);
+  Vector2 speed_direction = field_strength.GetRotatedMinus90( );
   speed_direction.Norm( );
 
   Vector2 distance_to_center = position - Vector2(DEFAULT_AREA_CENTER_X, DEFAULT_AREA_CENTER_Y);
@@ -588,7 +1399,13 @@ bool Store::MoveWave(Wave & wave)
   t = 0;
   #endif /* STOP_WAVES */
 
-  position += (speed_direction / DISTANT_SCALE) * FRONT_ELEMENT_MOVE_SPEED * t;
+  // Main element stops in the point where it hits grating, so HandleWave( ) finds collision however far it moves.
+  const Vector2 next_position = position + (speed_direction / DISTANT_SCALE) * FRONT_ELEMENT_MOVE_SPEED * t;
+  int grating_ind = -1;
+  if (CheckCollisions(position, next_position, wave.GetWaveStatus( ), &grating_ind, &position))
+  {
+    position = next_position;
+  }
   front_element.SetPosition(position);
 
   #ifdef STORE_MOVE_DEBUG
@@ -596,6 +1413,8 @@ bool Store::MoveWave(Wave & wave)
   std::cout << "Store::MoveWave() end\n";
   std::cout << std::endl;
   #endif /* STORE_MOVE_DEBUG */
+
+  return true;
 }
 
 bool Store::Clear()
@@ -603,8 +1422,16 @@ bool Store::Clear()
   for(auto & i : waves_)
     i.Clear();
 
-  waves_.clear();
+  waves_.Clear( );
 
   dipoles_.clear();
-  diffraction_gratings_.clear( );
+  dipole_pack_.Clear( );
+  phasor_grid_.Invalidate( );
+  phasor_grid_dipoles_number_ = 0;
+  dipole_tree_.Invalidate( );
+  iso_contours_.Invalidate( );
+  iso_contours_dipoles_number_ = 0;
+  linear_arrays_.Clear( );
+  diffraction_gratings_.Clear( );
+  grating_grid_.Clear( );
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "ThreadPool.h"
+
+#include <assert.h>
+#include <iostream>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace my_math
+{
+
+// True in the thread which is executing a chunk now. Nested ParallelFor is executed in place.
+static thread_local bool is_pool_task = false;
+
+namespace
+{
+
+// Chunk ranges are packed in one word: begin in high half and end in low half.
+const unsigned int RANGE_SHIFT = 32;
+const uint64_t RANGE_END_MASK = (static_cast<uint64_t>(1) << RANGE_SHIFT) - 1;
+
+inline uint64_t PackRange(const size_t begin, const size_t end)
+{
+  return (static_cast<uint64_t>(begin) << RANGE_SHIFT) | end;
+}
+
+inline size_t GetRangeBegin(const uint64_t range)
+{
+  return range >> RANGE_SHIFT;
+}
+
+inline size_t GetRangeEnd(const uint64_t range)
+{
+  return range & RANGE_END_MASK;
+}
+
+} // End of anonymous namespace.
+
+ThreadPool::ThreadPool(const unsigned int threads_number, const bool pin_threads)
+    :  is_stopped_(false),
+       job_(nullptr),
+       job_context_(nullptr),
+       job_count_(0),
+       job_chunk_size_(1),
+       job_chunks_number_(0),
+       job_generation_(0),
+       remaining_chunks_(0),
+       busy_workers_(0)  {
+
+  unsigned int threads = threads_number;
+  if (threads == 0)
+  {
+    threads = std::thread::hardware_concurrency( );
+  }
+
+  // Caller thread is one of the threads which execute tasks.
+  ranges_ = std::vector<ChunkRange>(threads > 0 ? threads : 1);
+  for (unsigned int ind = 1; ind < threads; ind++)
+  {
+    workers_.push_back(std::thread(&ThreadPool::WorkerLoop, this, ind));
+
+    if (pin_threads)
+    {
+      PinThread(workers_.back( ), ind);
+    }
+  }
+
+  #ifdef THREAD_POOL_DEBUG
+  std::cout << "ThreadPool: " << GetThreadsNumber( ) << " threads" << std::endl;
+  #endif /* THREAD_POOL_DEBUG */
+}
+
+ThreadPool::~ThreadPool( )
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopped_ = true;
+  }
+  wake_condition_.notify_all( );
+
+  for (auto& worker : workers_)
+  {
+    worker.join( );
+  }
+}
+
+unsigned int ThreadPool::GetThreadsNumber(void) const
+{
+  return workers_.size( ) + 1;
+}
+
+void ThreadPool::PinThread(std::thread & thread, const unsigned int cpu_ind)
+{
+  #ifdef __linux__
+  const unsigned int cpu_number = std::thread::hardware_concurrency( );
+  if (cpu_number == 0)
+  {
+    return;
+  }
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu_ind % cpu_number, &cpu_set);
+  if (pthread_setaffinity_np(thread.native_handle( ), sizeof(cpu_set_t), &cpu_set) != 0)
+  {
+    std::cout << "WARNING: thread wasn't pinned to cpu " << cpu_ind % cpu_number << std::endl;
+  }
+  #endif /* __linux__ */
+
+  return;
+}
+
+void ThreadPool::RunChunk(const size_t chunk)
+{
+  const size_t begin = chunk * job_chunk_size_;
+  const size_t end = std::min(begin + job_chunk_size_, job_count_);
+  job_(job_context_, begin, end);
+
+  if (remaining_chunks_.fetch_sub(1) == 1)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_condition_.notify_all( );
+  }
+  return;
+}
+
+bool ThreadPool::PopChunk(const unsigned int thread_ind, size_t *chunk)
+{
+  std::atomic<uint64_t> & range = ranges_[thread_ind].range;
+  uint64_t current = range.load( );
+  while (GetRangeBegin(current) < GetRangeEnd(current))
+  {
+    if (range.compare_exchange_weak(current, PackRange(GetRangeBegin(current) + 1, GetRangeEnd(current))))
+    {
+      *chunk = GetRangeBegin(current);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::StealChunk(const unsigned int thread_ind, size_t *chunk)
+{
+  const unsigned int threads = ranges_.size( );
+  for (unsigned int shift = 1; shift < threads; shift++)
+  {
+    std::atomic<uint64_t> & victim_range = ranges_[(thread_ind + shift) % threads].range;
+    uint64_t current = victim_range.load( );
+    while (GetRangeBegin(current) < GetRangeEnd(current))
+    {
+      const size_t begin = GetRangeBegin(current);
+      const size_t end = GetRangeEnd(current);
+      const size_t middle = begin + (end - begin) / 2;
+      if (victim_range.compare_exchange_weak(current, PackRange(begin, middle)))
+      {
+        // Own range is empty, so nobody changes it now. Thief executes the first stolen chunk and keeps the rest.
+        ranges_[thread_ind].range.store(PackRange(middle + 1, end));
+        *chunk = middle;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void ThreadPool::RunChunks(const unsigned int thread_ind)
+{
+  size_t chunk = 0;
+  while (PopChunk(thread_ind, &chunk) || StealChunk(thread_ind, &chunk))
+  {
+    RunChunk(chunk);
+  }
+  return;
+}
+
+void ThreadPool::WorkerLoop(const unsigned int worker_ind)
+{
+  is_pool_task = true;
+  unsigned long seen_generation = 0;
+
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_condition_.wait(lock, [&]( ) {
+        return is_stopped_ || (job_ != nullptr && job_generation_ != seen_generation);
+      });
+
+      if (is_stopped_)
+      {
+        return;
+      }
+
+      seen_generation = job_generation_;
+      busy_workers_++;
+    }
+
+    RunChunks(worker_ind);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_--;
+      done_condition_.notify_all( );
+    }
+  }
+}
+
+void ThreadPool::Run(const size_t count, const size_t chunk_size, const ChunkFunction func, void *context)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  const size_t chunk = chunk_size ? chunk_size : 1;
+  const size_t chunks_number = (count + chunk - 1) / chunk;
+
+  // Small jobs and jobs from tasks of this pool don't wake workers.
+  if (workers_.empty( ) || chunks_number == 1 || is_pool_task)
+  {
+    for (size_t begin = 0; begin < count; begin += chunk)
+    {
+      func(context, begin, std::min(begin + chunk, count));
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = func;
+    job_context_ = context;
+    job_count_ = count;
+    job_chunk_size_ = chunk;
+    job_chunks_number_ = chunks_number;
+    remaining_chunks_ = chunks_number;
+
+    // Every thread starts with equal part of chunks. Threads which sleep yet are robbed by busy ones.
+    assert(chunks_number <= RANGE_END_MASK);
+    const size_t threads = ranges_.size( );
+    for (size_t ind = 0; ind < threads; ind++)
+    {
+      ranges_[ind].range.store(PackRange(ind * chunks_number / threads, (ind + 1) * chunks_number / threads));
+    }
+    job_generation_++;
+  }
+  wake_condition_.notify_all( );
+
+  is_pool_task = true;
+  RunChunks(0);
+  is_pool_task = false;
+
+  // Job can be changed only when nobody reads it.
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_condition_.wait(lock, [&]( ) {
+    return remaining_chunks_ == 0 && busy_workers_ == 0;
+  });
+  job_ = nullptr;
+
+  return;
+}
+
+} // End of namespace my_math.
@@ -6,7 +6,8 @@ namespace my_math
 Wave::Wave( )
     :  drawn_sides_(BOTH_SIDES),
        wave_status_(ORDINARY_WAVE),
-       diffraction_grating_(nullptr)  { 
+       grating_handle_(NULL_SLOT_HANDLE),
+       secondary_source_handle_(NULL_SLOT_HANDLE)  { 
 }
 
 
@@ -14,26 +15,29 @@ Wave::Wave(const Wave &that)
     :  front_elements_(that.front_elements_),
        drawn_sides_(that.drawn_sides_),
        wave_status_(that.wave_status_),
-       diffraction_grating_(that.diffraction_grating_),
-       secondary_source_number_(that.secondary_source_number_)  {
+       grating_handle_(that.grating_handle_),
+       secondary_source_handle_(that.secondary_source_handle_),
+       front_paths_{that.front_paths_[0], that.front_paths_[1]}  {
 }
 
 
-Wave::Wave(Wave &&that)
+Wave::Wave(Wave &&that) noexcept
     :  front_elements_(std::move(that.front_elements_)),
        drawn_sides_(std::move(that.drawn_sides_)),
        wave_status_(std::move(that.wave_status_)),
-       diffraction_grating_(std::move(that.diffraction_grating_)),
-       secondary_source_number_(std::move(that.secondary_source_number_))  {
+       grating_handle_(std::move(that.grating_handle_)),
+       secondary_source_handle_(std::move(that.secondary_source_handle_)),
+       front_paths_{std::move(that.front_paths_[0]), std::move(that.front_paths_[1])}  {
 }
 
-void Wave::Swap(Wave & that)
+void Wave::Swap(Wave & that) noexcept
 {
   std::swap(front_elements_, that.front_elements_);
   std::swap(drawn_sides_, that.drawn_sides_);
   std::swap(wave_status_, that.wave_status_);
-  std::swap(diffraction_grating_, that.diffraction_grating_);
-  std::swap(secondary_source_number_, that.secondary_source_number_);
+  std::swap(grating_handle_, that.grating_handle_);
+  std::swap(secondary_source_handle_, that.secondary_source_handle_);
+  std::swap(front_paths_, that.front_paths_);
   return;
 }
 
@@ -45,7 +49,7 @@ Wave& Wave::operator=(const Wave & that)
   return *this;
 }
 
-Wave& Wave::operator=(Wave && that)
+Wave& Wave::operator=(Wave && that) noexcept
 {
   Swap(that);
   return *this;  
@@ -93,14 +97,27 @@ bool Wave::Push(const FrontElement & front_element)
   return true;
 }
 
+bool Wave::Push(FrontElement && front_element)
+{
+  front_elements_.push_back(std::move(front_element));
+  return true;
+}
+
 FrontElement & Wave::GetMain()
 {
   return front_elements_.front();
 }
 
+const FrontElement & Wave::GetMain() const
+{
+  return front_elements_.front();
+}
+
 bool Wave::Clear()
 {
   front_elements_.clear();
+  front_paths_[0].Clear( );
+  front_paths_[1].Clear( );
 }
 
 void Wave::SetDrawnSides(const DRAWN_SIDES drawn_sides)
@@ -125,30 +142,41 @@ const WAVE_STATUSES Wave::GetWaveStatus(void) const
   return wave_status_;
 }
 
-void Wave::SetDiffractionGrating(DiffractionGrating *diffraction_grating)
+void Wave::SetGratingHandle(const SlotHandle & grating_handle)
 {
-  diffraction_grating_ = diffraction_grating;
+  grating_handle_ = grating_handle;
   return;
 }
 
-DiffractionGrating* Wave::GetDiffractionGrating(void) const
+SlotHandle Wave::GetGratingHandle(void) const
 {
-  return diffraction_grating_;
+  return grating_handle_;
 }
 
-void Wave::SetSecondarySourceNumber(const int source_number)
+void Wave::SetSecondarySourceHandle(const SlotHandle & secondary_source_handle)
 {
-  secondary_source_number_ = source_number;
+  secondary_source_handle_ = secondary_source_handle;
 }
 
-int Wave::GetSecondarySourceNumber(void) const
+SlotHandle Wave::GetSecondarySourceHandle(void) const
 {
-  return secondary_source_number_;
+  return secondary_source_handle_;
+}
+
+const FrontPath & Wave::GetFrontPath(const bool is_top_part) const
+{
+  return front_paths_[is_top_part ? 0 : 1];
+}
+
+void Wave::SwapFrontPath(const bool is_top_part, FrontPath & front_path)
+{
+  std::swap(front_paths_[is_top_part ? 0 : 1], front_path);
+  return;
 }
 
-bool Wave::IsInterfere(void)
+bool Wave::IsInterfere(const DiffractionGrating & diffraction_grating) const
 {
-  if (GetMain( ).GetPosition( ).GetX( ) - (*diffraction_grating_).Right( ) > INTERFERENCE_LENGTH)
+  if (GetMain( ).GetPosition( ).GetX( ) - diffraction_grating.Right( ) > INTERFERENCE_LENGTH)
   {
     return true;
   }
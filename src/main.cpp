@@ -7,6 +7,8 @@
 #include "Store.h"
 #include "Wave.h"
 #include "Handlers.h"
+#include "FastTrig.h"
+#include "LinearArrays.h"
 
 using namespace my_math;
 
@@ -18,6 +20,14 @@ int main()
 
   time_start = std::chrono::high_resolution_clock::now();
 
+  #ifdef TRIG_ERRORS_REPORT
+  ReportTrigErrors( );
+  #endif /* TRIG_ERRORS_REPORT */
+
+  #ifdef ARRAY_FACTOR_ERRORS_REPORT
+  ReportArrayFactorErrors( );
+  #endif /* ARRAY_FACTOR_ERRORS_REPORT */
+
   Store store;
 
   while(window.isOpen())